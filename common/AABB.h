@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Precision.h"
 
 /*
  * Axis aligned bounding box for broad phase collision detection 
@@ -8,29 +9,29 @@ class AABB
 {
 	
 	// we also save the vertices in homogenious coordinates for easy transformation
-	dvec4 vertices[8];
+	rvec4 vertices[8];
 
 public:
 
-	dvec3 min;
-	dvec3 max;
+	rvec3 min;
+	rvec3 max;
 
-	const dvec3 GetMin()
+	const rvec3 GetMin()
 	{
 		return min;
 	}
 
-	const dvec3 GetMax()
+	const rvec3 GetMax()
 	{
 		return max;
 	}
 
-	dvec3 GetPosition()
+	rvec3 GetPosition()
 	{
-		return (min + max) / 2.0;
+		return (min + max) / real(2);
 	}
 
-	dvec3 GetScale()
+	rvec3 GetScale()
 	{
 		return (max - min);
 	}
@@ -50,7 +51,7 @@ public:
 		vertices[7] = other.vertices[7];
 	}
 
-	void Set(dvec3 min, dvec3 max)
+	void Set(rvec3 min, rvec3 max)
 	{
 		this->min = min;
 		this->max = max;
@@ -66,7 +67,7 @@ public:
 	}
 
 	// transforms to space given by M
-	void Transform(const dmat4& M)
+	void Transform(const rmat4& M)
 	{
 		for (size_t i=0; i<8; ++i)
 		{
@@ -77,7 +78,7 @@ public:
 
 		for (size_t i=1; i<8; ++i)
 		{
-			dvec4 v = vertices[i];
+			rvec4 v = vertices[i];
 
 			min.x = std::min(v.x, min.x);
 			min.y = std::min(v.y, min.y);
@@ -89,6 +90,35 @@ public:
 		}
 	}
 
+	// sets the box to the local box transformed by the affine map x -> A*x + t, from center and extents
+	// |A| (absolute values of the entries) maps the extents, same result as transforming the 8 corners
+	// reference: Arvo, Transforming Axis-Aligned Bounding Boxes (Graphics Gems 1990)
+	void SetTransformed(const AABB& local, const rmat3& A, const rvec3 t)
+	{
+		rvec3 c = real(0.5) * (local.min + local.max);
+		rvec3 e = real(0.5) * (local.max - local.min);
+
+		rvec3 center = A*c + t;
+		rvec3 extents(
+			std::abs(A[0][0])*e.x + std::abs(A[1][0])*e.y + std::abs(A[2][0])*e.z,
+			std::abs(A[0][1])*e.x + std::abs(A[1][1])*e.y + std::abs(A[2][1])*e.z,
+			std::abs(A[0][2])*e.x + std::abs(A[1][2])*e.y + std::abs(A[2][2])*e.z);
+
+		min = center - extents;
+		max = center + extents;
+	}
+
+	// intersection of the boxes enlarged by margin (used for speculative contacts)
+	bool IntersectsWith(AABB& b, real margin)
+	{
+		return !(b.min.x > max.x + margin
+			|| b.min.y > max.y + margin
+			|| b.min.z > max.z + margin
+			|| b.max.x < min.x - margin
+			|| b.max.y < min.y - margin
+			|| b.max.z < min.z - margin);
+	}
+
 	bool IntersectsWith(AABB& b)
 	{
 		return !(b.min.x > max.x
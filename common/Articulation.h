@@ -0,0 +1,507 @@
+/*
+ * Tree of rigid bodies simulated in joint coordinates (reduced coordinates)
+ */
+
+#pragma once
+
+#include <vector>
+#include <assert.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "RigidBody.h"
+
+using namespace glm;
+
+enum JointType
+{
+	Revolute, Spherical
+};
+
+// spatial vector (plücker coordinates) with the world origin as reference point
+// motion: (omega, velocity of the body point at the origin), force: (torque about the origin, force)
+struct SpatialVector
+{
+	rvec3 w;
+	rvec3 v;
+
+	SpatialVector() : w(0), v(0) {}
+	SpatialVector(rvec3 w, rvec3 v) : w(w), v(v) {}
+
+	SpatialVector operator+(const SpatialVector& b) const { return SpatialVector(w + b.w, v + b.v); }
+	SpatialVector operator-(const SpatialVector& b) const { return SpatialVector(w - b.w, v - b.v); }
+	SpatialVector operator-() const { return SpatialVector(-w, -v); }
+	SpatialVector operator*(real s) const { return SpatialVector(w*s, v*s); }
+	SpatialVector& operator+=(const SpatialVector& b) { w += b.w; v += b.v; return *this; }
+
+	// motion · force
+	real Dot(const SpatialVector& f) const { return dot(w, f.w) + dot(v, f.v); }
+
+	// motion x motion
+	SpatialVector CrossMotion(const SpatialVector& m) const { return SpatialVector(cross(w, m.w), cross(w, m.v) + cross(v, m.w)); }
+
+	// motion x* force
+	SpatialVector CrossForce(const SpatialVector& f) const { return SpatialVector(cross(w, f.w) + cross(v, f.v), cross(w, f.v)); }
+};
+
+// 6x6 matrix [A B; C D] in 3x3 blocks
+struct SpatialMatrix
+{
+	rmat3 A, B, C, D;
+
+	SpatialMatrix() : A(0), B(0), C(0), D(0) {}
+	SpatialMatrix(rmat3 A, rmat3 B, rmat3 C, rmat3 D) : A(A), B(B), C(C), D(D) {}
+
+	SpatialVector operator*(const SpatialVector& x) const { return SpatialVector(A*x.w + B*x.v, C*x.w + D*x.v); }
+	SpatialMatrix operator+(const SpatialMatrix& m) const { return SpatialMatrix(A + m.A, B + m.B, C + m.C, D + m.D); }
+	SpatialMatrix operator-(const SpatialMatrix& m) const { return SpatialMatrix(A - m.A, B - m.B, C - m.C, D - m.D); }
+	SpatialMatrix& operator+=(const SpatialMatrix& m) { A += m.A; B += m.B; C += m.C; D += m.D; return *this; }
+
+	// a*b^T
+	static SpatialMatrix Outer(const SpatialVector& a, const SpatialVector& b)
+	{
+		return SpatialMatrix(outerProduct(a.w, b.w), outerProduct(a.w, b.v), outerProduct(a.v, b.w), outerProduct(a.v, b.v));
+	}
+
+	// spatial inertia of a body with mass m, inertia tensor Ic (world orientation) about its center c
+	static SpatialMatrix Inertia(real m, const rmat3& Ic, const rvec3& c)
+	{
+		rmat3 cx = skew(c);
+		return SpatialMatrix(Ic + m*cx*transpose(cx), m*cx, m*transpose(cx), rmat3(m));
+	}
+
+	static rmat3 skew(const rvec3& v)
+	{
+		return rmat3(0, v.z, -v.y,  -v.z, 0, v.x,  v.y, -v.x, 0);
+	}
+
+	// solves M*x = b (gaussian elimination with partial pivoting)
+	SpatialVector Solve(const SpatialVector& b) const
+	{
+		real m[6][7];
+		for (int r=0; r<3; ++r)
+		{
+			for (int c=0; c<3; ++c)
+			{
+				// glm is column major: X[c][r]
+				m[r][c] = A[c][r];     m[r][c+3] = B[c][r];
+				m[r+3][c] = C[c][r];   m[r+3][c+3] = D[c][r];
+			}
+			m[r][6] = b.w[r];
+			m[r+3][6] = b.v[r];
+		}
+
+		for (int col=0; col<6; ++col)
+		{
+			int pivot = col;
+			for (int r=col+1; r<6; ++r) if (std::abs(m[r][col]) > std::abs(m[pivot][col])) pivot = r;
+			for (int k=0; k<7; ++k) std::swap(m[col][k], m[pivot][k]);
+
+			for (int r=col+1; r<6; ++r)
+			{
+				real f = m[r][col]/m[col][col];
+				for (int k=col; k<7; ++k) m[r][k] -= f*m[col][k];
+			}
+		}
+
+		real x[6];
+		for (int r=5; r>=0; --r)
+		{
+			real sum = m[r][6];
+			for (int k=r+1; k<6; ++k) sum -= m[r][k]*x[k];
+			x[r] = sum/m[r][r];
+		}
+		return SpatialVector(rvec3(x[0], x[1], x[2]), rvec3(x[3], x[4], x[5]));
+	}
+};
+
+
+/*
+ * Articulated bodies in reduced coordinates, the joints can not drift apart.
+ * Forward dynamics with the articulated body algorithm, O(n) in the number of links
+ * reference: Featherstone, Rigid Body Dynamics Algorithms, chapter 7 (ABA) and chapter 11 (impulses)
+ *
+ * The links are normal rigid bodies for the collision detection and the constraint solver. The impulses
+ * the solver applies to them (contacts, gravity) are projected back into joint space with the impulse
+ * version of the ABA, which distributes them over the whole tree.
+ */
+class Articulation
+{
+
+public:
+
+	// root: link 0, fixed if the body is static or fixedRoot is set (floating base otherwise)
+	Articulation(RigidBody* root, bool fixedRoot = false)
+	{
+		this->fixedRoot = fixedRoot || root->isStatic;
+
+		Link l;
+		l.body = root;
+		l.parent = -1;
+		l.dof = 0;
+		if (!this->fixedRoot) l.v = SpatialVector(root->angularVelocity, root->velocity - cross(root->angularVelocity, root->position));
+		links.push_back(l);
+
+		root->articulated = !root->isStatic;
+		root->SetSleepingEnabled(false);
+	}
+
+	// hinge around the global axis through the global anchor, returns the index of the link
+	int AddRevoluteLink(int parent, RigidBody* body, rvec3 axisGlobal, rvec3 anchorGlobal)
+	{
+		Link& l = addLink(parent, body, anchorGlobal, Revolute);
+		RigidBody* p = links[parent].body;
+		l.axis = normalize(inverse(p->rotation) * normalize(axisGlobal));
+
+		// initial joint velocity from the current body velocities
+		l.qd = rvec3(dot(body->angularVelocity - p->angularVelocity, normalize(axisGlobal)), 0, 0);
+		return (int)links.size() - 1;
+	}
+
+	// ball joint at the global anchor, returns the index of the link
+	int AddSphericalLink(int parent, RigidBody* body, rvec3 anchorGlobal)
+	{
+		addLink(parent, body, anchorGlobal, Spherical);
+		return (int)links.size() - 1;
+	}
+
+	int GetNumberOfLinks() { return (int)links.size(); }
+	RigidBody* GetLinkBody(int i) { return links[i].body; }
+
+	// angle of a revolute joint
+	real GetJointAngle(int i) { return links[i].angle; }
+
+	// joint coordinates and velocities for the snapshots of the physic manager, appended to states
+	void SaveState(std::vector<LinkState>& states) const
+	{
+		for (const Link& l : links)
+		{
+			LinkState s;
+			s.angle = l.angle;
+			s.relRotation = l.relRotation;
+			s.qd = l.qd;
+			s.w = l.v.w;
+			s.v = l.v.v;
+			s.momentum = l.momentum;
+			s.angularMomentum = l.angularMomentum;
+			states.push_back(s);
+		}
+	}
+
+	// restores from states[first], returns the index after the last link
+	int RestoreState(const std::vector<LinkState>& states, int first)
+	{
+		for (Link& l : links)
+		{
+			const LinkState& s = states[first++];
+			l.angle = s.angle;
+			l.relRotation = s.relRotation;
+			l.qd = s.qd;
+			l.v = SpatialVector(s.w, s.v);
+			l.momentum = s.momentum;
+			l.angularMomentum = s.angularMomentum;
+		}
+		return first;
+	}
+
+	// integrates the joint coordinates (positions with the current velocities, then velocities with the
+	// forces of the links) and writes the resulting state into the rigid bodies
+	void Integrate(real dt)
+	{
+		integratePositions(dt);
+		forwardKinematics();
+
+		computeVelocities();
+		computeArticulatedInertias(true);
+
+		// root acceleration
+		SpatialVector a0;
+		if (!fixedRoot) a0 = -links[0].IA.Solve(links[0].pA);
+		if (!fixedRoot) links[0].v += a0*dt;
+
+		accelerate(a0, dt, true);
+
+		computeVelocities();
+		writeBodies();
+	}
+
+	// projects the momentum changes applied to the links since the last Integrate/ApplyImpulses (by the
+	// constraint solver) into joint space, afterwards the links move consistently with the joints again
+	void ApplyImpulses()
+	{
+		for (int i=(int)links.size()-1; i>=0; --i)
+		{
+			Link& l = links[i];
+			RigidBody* b = l.body;
+
+			// spatial impulse at the origin
+			rvec3 dp = b->linearMomentum - l.momentum;
+			rvec3 dL = b->angularMomentum - l.angularMomentum;
+			l.pA = -SpatialVector(dL + cross(b->position, dp), dp);
+		}
+
+		// impulse ABA: no velocity product terms, the articulated inertias of the last Integrate are still valid
+		computeArticulatedInertias(false);
+
+		SpatialVector da0;
+		if (!fixedRoot) da0 = -links[0].IA.Solve(links[0].pA);
+		if (!fixedRoot) links[0].v += da0;
+
+		accelerate(da0, 1, false);
+
+		computeVelocities();
+		writeBodies();
+	}
+
+private:
+
+	struct Link
+	{
+		RigidBody* body;
+		int parent;
+		JointType type;
+		int dof;
+
+		rvec3 anchorParent; // joint in the (unrotated) parent coordinates, relative to the parent center
+		rvec3 anchorChild; // joint in the (unrotated) body coordinates, relative to the body center
+		rvec3 axis; // revolute axis in parent coordinates
+		rquat restRotation; // rotation relative to the parent at angle 0
+
+		real angle = 0; // revolute
+		rquat relRotation; // rotation relative to the parent
+		rvec3 qd = rvec3(0); // joint velocity (revolute: x; spherical: angular velocity in body coordinates)
+
+		// scratch of the ABA passes
+		SpatialVector S[3]; // motion subspace
+		SpatialVector v; // spatial velocity
+		SpatialVector c; // velocity product acceleration
+		SpatialVector pA; // articulated bias force
+		SpatialMatrix IA; // articulated inertia
+		SpatialVector U[3];
+		rmat3 Dinv;
+		rvec3 u;
+		SpatialVector a;
+
+		// momentum written to the body, used to find the impulses of the solver
+		rvec3 momentum;
+		rvec3 angularMomentum;
+	};
+
+	std::vector<Link> links; // parents are always before their children
+	bool fixedRoot;
+
+	Link& addLink(int parent, RigidBody* body, rvec3 anchorGlobal, JointType type)
+	{
+		assert(parent >= 0 && parent < (int)links.size());
+		RigidBody* p = links[parent].body;
+
+		Link l;
+		l.body = body;
+		l.parent = parent;
+		l.type = type;
+		l.dof = type == Revolute ? 1 : 3;
+		l.anchorParent = inverse(p->rotation) * (anchorGlobal - p->position);
+		l.anchorChild = inverse(body->rotation) * (anchorGlobal - body->position);
+		l.restRotation = inverse(p->rotation) * body->rotation;
+		l.relRotation = l.restRotation;
+
+		// initial joint velocity from the current body velocities
+		if (type == Spherical) l.qd = inverse(body->rotation) * (body->angularVelocity - p->angularVelocity);
+
+		body->articulated = true;
+		body->SetSleepingEnabled(false);
+
+		links.push_back(l);
+		return links.back();
+	}
+
+	void integratePositions(real dt)
+	{
+		Link& root = links[0];
+		if (!fixedRoot)
+		{
+			RigidBody* b = root.body;
+			rvec3 omega = root.v.w;
+			b->position += dt*(root.v.v + cross(omega, b->position));
+			b->rotation += rquat(0, 0.5*dt*omega.x, 0.5*dt*omega.y, 0.5*dt*omega.z) * b->rotation;
+			b->rotation = normalize(b->rotation);
+		}
+
+		for (size_t i=1; i<links.size(); ++i)
+		{
+			Link& l = links[i];
+			if (l.type == Revolute)
+			{
+				l.angle += dt*l.qd.x;
+			}
+			else
+			{
+				// qd is in body coordinates: d/dt relRotation = relRotation * (0, qd)/2
+				rvec3 w = l.qd;
+				l.relRotation += l.relRotation * rquat(0, 0.5*dt*w.x, 0.5*dt*w.y, 0.5*dt*w.z);
+				l.relRotation = normalize(l.relRotation);
+			}
+		}
+	}
+
+	// positions and orientations of the links from the joint coordinates
+	void forwardKinematics()
+	{
+		for (size_t i=1; i<links.size(); ++i)
+		{
+			Link& l = links[i];
+			RigidBody* p = links[l.parent].body;
+			RigidBody* b = l.body;
+
+			if (l.type == Revolute)
+			{
+				real s = std::sin(0.5*l.angle);
+				l.relRotation = rquat(std::cos(0.5*l.angle), s*l.axis.x, s*l.axis.y, s*l.axis.z) * l.restRotation;
+			}
+
+			b->rotation = normalize(p->rotation * l.relRotation);
+			rvec3 anchor = p->position + p->rotation * l.anchorParent;
+			b->position = anchor - b->rotation * l.anchorChild;
+		}
+	}
+
+	// motion subspaces and spatial velocities of all links
+	void computeVelocities()
+	{
+		if (fixedRoot) links[0].v = SpatialVector();
+
+		for (size_t i=1; i<links.size(); ++i)
+		{
+			Link& l = links[i];
+			RigidBody* p = links[l.parent].body;
+			RigidBody* b = l.body;
+			rvec3 anchor = p->position + p->rotation * l.anchorParent;
+
+			if (l.type == Revolute)
+			{
+				rvec3 a = p->rotation * l.axis;
+				l.S[0] = SpatialVector(a, cross(anchor, a));
+			}
+			else
+			{
+				rmat3 R = glm::mat3_cast(b->rotation);
+				for (int k=0; k<3; ++k) l.S[k] = SpatialVector(R[k], cross(anchor, R[k]));
+			}
+
+			SpatialVector vJ;
+			for (int k=0; k<l.dof; ++k) vJ += l.S[k]*l.qd[k];
+
+			l.v = links[l.parent].v + vJ;
+			l.c = l.v.CrossMotion(vJ); // S is fixed in the body: dS/dt = v x S
+		}
+	}
+
+	// backward pass of the ABA, with dynamics the bias forces (velocity products and external forces) are
+	// computed first, otherwise the pA of the links are the (negative) impulses set by the caller
+	void computeArticulatedInertias(bool dynamics)
+	{
+		for (Link& l : links)
+		{
+			if (!dynamics) continue;
+
+			RigidBody* b = l.body;
+			real m = b->inverseMass > 0 ? 1./b->inverseMass : 0;
+			rmat3 R = glm::mat3_cast(b->rotation);
+			rmat3 Ic = b->isStatic ? rmat3(0) : R * inverse(b->inertiaTensorBodyInverse) * transpose(R);
+
+			l.IA = SpatialMatrix::Inertia(m, Ic, b->position);
+
+			SpatialVector fExt(b->torque + cross(b->position, b->force), b->force);
+			l.pA = l.v.CrossForce(l.IA * l.v) - fExt;
+		}
+
+		for (int i=(int)links.size()-1; i>0; --i)
+		{
+			Link& l = links[i];
+			Link& p = links[l.parent];
+
+			if (dynamics)
+			{
+				// D = S^T*IA*S, padded with the identity for the unused degrees of freedom
+				rmat3 D(1);
+				for (int k=0; k<l.dof; ++k) l.U[k] = l.IA * l.S[k];
+				for (int k=0; k<l.dof; ++k)
+					for (int j=0; j<l.dof; ++j)
+						D[j][k] = l.S[k].Dot(l.U[j]);
+				l.Dinv = inverse(D);
+			}
+
+			l.u = rvec3(0);
+			for (int k=0; k<l.dof; ++k) l.u[k] = -l.S[k].Dot(l.pA);
+
+			rvec3 Du = l.Dinv * l.u;
+			SpatialVector pa = l.pA;
+			for (int k=0; k<l.dof; ++k) pa += l.U[k]*Du[k];
+
+			if (dynamics)
+			{
+				SpatialMatrix Ia = l.IA;
+				for (int k=0; k<l.dof; ++k)
+					for (int j=0; j<l.dof; ++j)
+						Ia = Ia - SpatialMatrix::Outer(l.U[k], l.U[j]*l.Dinv[j][k]);
+
+				pa += Ia * l.c;
+				p.IA += Ia;
+			}
+			p.pA += pa;
+		}
+	}
+
+	// forward pass of the ABA, integrates the joint velocities with the accelerations (or applies the
+	// velocity changes of the impulses with dt = 1)
+	void accelerate(SpatialVector a0, real dt, bool dynamics)
+	{
+		links[0].a = a0;
+		for (size_t i=1; i<links.size(); ++i)
+		{
+			Link& l = links[i];
+			SpatialVector a = links[l.parent].a;
+			if (dynamics) a += l.c;
+
+			rvec3 t = l.u;
+			for (int k=0; k<l.dof; ++k) t[k] -= l.U[k].Dot(a);
+			rvec3 qdd = l.Dinv * t; // zero for the unused degrees of freedom
+
+			for (int k=0; k<l.dof; ++k) a += l.S[k]*qdd[k];
+			l.a = a;
+
+			l.qd += qdd*dt;
+		}
+	}
+
+	// writes pose and velocities into the rigid bodies (the solver works on them)
+	void writeBodies()
+	{
+		for (size_t i=0; i<links.size(); ++i)
+		{
+			Link& l = links[i];
+			RigidBody* b = l.body;
+
+			if (!b->isStatic)
+			{
+				rmat3 R = glm::mat3_cast(b->rotation);
+				b->inertiaTensorInverse = R * b->inertiaTensorBodyInverse * transpose(R);
+
+				b->angularVelocity = l.v.w;
+				b->velocity = l.v.v + cross(l.v.w, b->position);
+				b->linearMomentum = b->velocity / b->inverseMass;
+				b->angularMomentum = inverse(b->inertiaTensorInverse) * b->angularVelocity;
+
+				b->pseudoVelocity = rvec3(0); // split impulse position correction is not supported for links
+				b->pseudoAngularVelocity = rvec3(0);
+
+				b->isDirty = true;
+				b->UpdateAABB();
+			}
+
+			l.momentum = b->linearMomentum;
+			l.angularMomentum = b->angularMomentum;
+		}
+	}
+};
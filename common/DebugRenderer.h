@@ -1,150 +1,41 @@
 #pragma once
 
-#include "Model.h"
-#include "Mesh.h"
-#include <functional>
-#include <list>
-#include <unordered_map>
+#include <glm/glm.hpp>
+using namespace glm;
 
+#include <vector>
+#include <map>
+#include <cstddef>
 
-/*
- * Model that is only a single point which is convienient to draw debug information.
- */
-class DebugPoint : public Model
-{
-private:
-		GLfloat size;
-		vec3 color;
+#include "Shader.h"
 
-public:
-	DebugPoint(vec3 pos, vec3 color, GLfloat size = 10) : Model(MeshGenerator::CreatePoint(color), pos)
-	{
-		this->size = size;
-		this->color = color;
-	}
 
-	void SetSize(GLfloat size) { this->size = size; }
-
-	void SetColor(vec3 c)
-	{
-		if (c != color)
-		{
-			assert(false);
-			this->color = c;
-			delete mesh;
-			mesh = MeshGenerator::CreatePoint(c);
-		}
-	}
-	
-	virtual void Draw(Shader& shader) 
-	{
-		#ifdef PLATFORM_DESKTOP
-		glPointSize(this->size);
-		#endif
-		Model::Draw(shader);
-	}
-};
-
-class DebugBox : public Model
+// vertex of the debug draw commands (world coordinates)
+struct DebugVertex
 {
+	vec3 position;
 	vec3 color;
-public:
-	DebugBox(vec3 pos, vec3 color) : Model(MeshGenerator::CreateBox(color), pos)
-	{
-		this->mesh->SetDrawMode(GL_LINE_LOOP);
-		this->color = color;
-	}
-
-	void SetColor(vec3 c)
-	{
-		if (c!= color)
-		{
-			assert(false);
-			this->color = c;
-			delete mesh;
-			mesh = MeshGenerator::CreateBox(c);
-			this->mesh->SetDrawMode(GL_LINE_LOOP);
-		}
-	}
-};
-
-template <class T>
-class DebugModelPool
-{
-	std::list<T*> notUsed;
-	std::list<T*> toDraw;
-
-public:
-	DebugModelPool()
-	{
-	}
-
-	~DebugModelPool()
-	{
-		Clear();
-	}
-
-	void Clear()
-	{
-		for (T* d : notUsed)
-		{
-			delete d;
-		}
-		for (T* d : toDraw)
-		{
-			delete d;
-		}
-		notUsed.clear();
-		toDraw.clear();
-	}
-
-
-	void Draw(Shader& shader)
-	{
-		for (T* p : toDraw)
-		{
-			p->Draw(shader);
-			notUsed.push_back(p);
-		}
-
-		toDraw.clear();
-	}	
-
-	int Size()
-	{
-		return notUsed.size() + toDraw.size();
-	}
-
-	T* AddObject(std::function<T*()> alloc)
-	{
-		T* p;
-		if (notUsed.size() == 0) 
-		{
-			p = alloc();
-		}
-		else
-		{
-			p = notUsed.back();
-			notUsed.pop_back();
-		}
-		
-		toDraw.push_back(p);
-
-		return p;
-	}
 };
 
 
 /*
- * Static helper class used by render manager to draw additional points in the scene
+ * Static helper class used by render manager to draw additional points, lines and boxes in the scene.
+ * The debug draw commands are collected as raw vertices during the frame and rendered with one draw call
+ * per primitive type (points with one call per point size). Nothing is collected while disabled.
  */
 class DebugRenderer
 {
 private:
 	bool enabled = false;
 
-	std::unordered_map<vec3, DebugModelPool<DebugPoint>*, Vec3Op> points;
-	std::unordered_map<vec3, DebugModelPool<DebugBox>*, Vec3Op> boxes;
+	// commands of the current frame
+	std::map<GLfloat, std::vector<DebugVertex>> points; // by point size
+	std::vector<DebugVertex> lines; // two vertices per line
+
+	// all vertices of a frame are uploaded at once: the lines, then the points
+	std::vector<DebugVertex> vertices;
+	GLuint VAO = 0;
+	GLuint VBO = 0;
 
 public:
 
@@ -164,74 +55,146 @@ public:
 	void Disable()
 	{
 		this->enabled = false;
+		clear();
 	}
 
+	// callers can skip collecting their debug information if disabled
+	bool IsEnabled() { return enabled; }
+
 	void AddDebugPoint(vec3 pos, vec3 color, GLfloat size)
 	{
 		#ifdef PLATFORM_DESKTOP
 		if (!enabled) return;
 
-		if (points[color] == NULL)
-			points[color] = new DebugModelPool<DebugPoint>();
-
-		DebugPoint* p = points[color]->AddObject([&]() { return new DebugPoint(pos, color, size); });
-		p->SetPosition(pos);
-		p->SetSize(size);
-		p->SetColor(color);
+		DebugVertex v = { pos, color };
+		points[size].push_back(v);
 		#endif
 	}
 
+	void AddDebugLine(vec3 a, vec3 b, vec3 color)
+	{
+		if (!enabled) return;
+
+		DebugVertex va = { a, color };
+		DebugVertex vb = { b, color };
+		lines.push_back(va);
+		lines.push_back(vb);
+	}
+
+	// wireframe of the box with center pos and size scale
 	void AddDebugBox(vec3 pos, vec3 color, vec3 scale)
 	{
 		if (!enabled) return;
 
-		if (boxes[color] == NULL)
-			boxes[color] = new DebugModelPool<DebugBox>();
+		vec3 min = pos - scale * 0.5f;
+		vec3 max = pos + scale * 0.5f;
 
-		DebugBox* p = boxes[color]->AddObject([&]() { return new DebugBox(pos, color); });
-		p->SetPosition(pos);
-		p->SetScale(scale);
-		p->SetColor(color);
+		// the 12 edges, corner i has the coordinates of max where bit 0 (x), 1 (y), 2 (z) is set
+		for (int i=0; i<8; ++i)
+		{
+			vec3 corner((i & 1) ? max.x : min.x, (i & 2) ? max.y : min.y, (i & 4) ? max.z : min.z);
+			for (int axis=0; axis<3; ++axis)
+			{
+				if (i & (1 << axis)) continue;
+
+				vec3 other = corner;
+				other[axis] = max[axis];
+				AddDebugLine(corner, other, color);
+			}
+		}
 	}
 
 	void Draw(Shader& shader)
 	{
 		if (!enabled) return;
-		for (const std::pair<vec3, DebugModelPool<DebugPoint>*> p : points)
+
+		vertices.clear();
+		vertices.insert(vertices.end(), lines.begin(), lines.end());
+		for (const std::pair<const GLfloat, std::vector<DebugVertex>>& p : points)
 		{
-			p.second->Draw(shader);
+			vertices.insert(vertices.end(), p.second.begin(), p.second.end());
 		}
-		for (const std::pair<vec3, DebugModelPool<DebugBox>*> p : boxes)
+		if (vertices.empty()) return;
+
+		if (VAO == 0) setupBuffers();
+
+		glBindVertexArray(VAO);
+		glBindBuffer(GL_ARRAY_BUFFER, VBO);
+		glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(DebugVertex), &vertices[0], GL_STREAM_DRAW);
+
+		// the vertices are in world coordinates, the instance matrix of the debug shader is the identity
+		// (constant attribute, the instance matrix arrays are disabled)
+		glVertexAttrib4f(4, 1, 0, 0, 0);
+		glVertexAttrib4f(5, 0, 1, 0, 0);
+		glVertexAttrib4f(6, 0, 0, 1, 0);
+		glVertexAttrib4f(7, 0, 0, 0, 1);
+
+		GLint first = 0;
+		if (!lines.empty())
+		{
+			glDrawArrays(GL_LINES, first, lines.size());
+			first += lines.size();
+		}
+
+		for (const std::pair<const GLfloat, std::vector<DebugVertex>>& p : points)
 		{
-			p.second->Draw(shader);
+			if (p.second.empty()) continue;
+
+			#ifdef PLATFORM_DESKTOP
+			glPointSize(p.first);
+			#endif
+			glDrawArrays(GL_POINTS, first, p.second.size());
+			first += p.second.size();
 		}
 
-		//std::cout << "boxes = " << boxes.Size() << " points = " << points.Size() << std::endl;
+		glBindVertexArray(0);
+
+		clear();
 	}
 
 
 private:
 
+	// the commands are drawn once (the capacity of the vectors is kept for the next frame)
+	void clear()
+	{
+		for (std::pair<const GLfloat, std::vector<DebugVertex>>& p : points)
+		{
+			p.second.clear();
+		}
+		lines.clear();
+	}
+
+	void setupBuffers()
+	{
+		glGenVertexArrays(1, &VAO);
+		glGenBuffers(1, &VBO);
+
+		glBindVertexArray(VAO);
+		glBindBuffer(GL_ARRAY_BUFFER, VBO);
+
+		// same locations as the vertex positions and colors of the meshes
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(DebugVertex), (GLvoid*)offsetof(DebugVertex, position));
+		glEnableVertexAttribArray(2);
+		glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(DebugVertex), (GLvoid*)offsetof(DebugVertex, color));
+
+		glBindVertexArray(0);
+	}
+
 	// singleton stuff
 	//
-	
+
     static DebugRenderer* _instance;
     DebugRenderer () { } /* verhindert, dass ein Objekt von außerhalb von DebugRenderer erzeugt wird. */
               // protected, wenn man von der Klasse noch erben möchte
     DebugRenderer ( const DebugRenderer& ); /* verhindert, dass eine weitere Instanz via
  Kopie-Konstruktor erstellt werden kann */
-    ~DebugRenderer () 
-	{ 
-		for (const std::pair<vec3, DebugModelPool<DebugPoint>*> p : points)
-		{
-			delete p.second;
-		}
-		for (const std::pair<vec3, DebugModelPool<DebugBox>*> p : boxes)
-		{
-			delete p.second;
-		}
+    ~DebugRenderer ()
+	{
+		// the buffers are freed with the context (which is already destroyed at exit)
 		points.clear();
-		boxes.clear();
+		lines.clear();
 	}
 
     class CGuard
@@ -130,6 +130,7 @@ public:
 	}
 
 	std::vector<Entity*> GetChildren(){	return this->children; }
+	Entity* GetParent() { return this->parent; }
 
 	virtual void Update(double dt)
 	{
@@ -174,6 +175,15 @@ public:
 
 	void SetDirty() { this->dirty = true; }
 
+	// sets the transform together with its already computed matrix (see TransformSync, only without parent)
+	void SetTransform(const vec3& pos, const quat& rot, const mat4& M)
+	{
+		this->position = pos;
+		this->rotation = rot;
+		this->M = M;
+		this->dirty = false;
+	}
+
 	mat4 GetTransformMatrix()
 	{
 		if (dirty)
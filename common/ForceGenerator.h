@@ -0,0 +1,188 @@
+/*
+ * External forces evaluated by the physic manager for every dynamic body in each substep
+ * (in the same pass as the integration, see PhysicManager::applyExternalForces)
+ */
+
+#pragma once
+
+#include <algorithm>
+
+#include <glm/glm.hpp>
+
+#include "RigidBody.h"
+#include "AABB.h"
+
+using namespace glm;
+
+#define FORCE_GENERATOR_INFINITY 1e30
+
+class ForceGenerator
+{
+public:
+
+	// local generators only visit the bodies whose aabb intersects the region
+	bool local = false;
+	AABB region;
+
+	virtual ~ForceGenerator() {}
+
+	// adds the force/torque (or an impulse) to the body, called in parallel for different bodies (no shared state allowed)
+	virtual void Apply(RigidBody* b, real dt) = 0;
+
+	// one shot generators (impulses) are removed after they were applied once
+	virtual bool IsOneShot() { return false; }
+
+	// inactive (sleeping) bodies in the region are reactivated before the generator is applied
+	virtual bool WakesBodies() { return false; }
+
+	void SetRegion(rvec3 min, rvec3 max)
+	{
+		local = true;
+		region.Set(min, max);
+	}
+};
+
+/*
+ * Gravity as a force, like the default gravity of the physic manager it is not scaled by the mass
+ * (with a region: e.g. zones of changed or inverted gravity)
+ */
+class GravityGenerator : public ForceGenerator
+{
+public:
+	rvec3 gravity;
+
+	GravityGenerator(rvec3 gravity)
+	{
+		this->gravity = gravity;
+	}
+
+	GravityGenerator(rvec3 gravity, rvec3 regionMin, rvec3 regionMax)
+	{
+		this->gravity = gravity;
+		SetRegion(regionMin, regionMax);
+	}
+
+	virtual void Apply(RigidBody* b, real dt)
+	{
+		if (local)
+		{
+			// only bodies whose center is inside the region
+			rvec3 p = b->GetPosition();
+			if (p.x < region.min.x || p.y < region.min.y || p.z < region.min.z) return;
+			if (p.x > region.max.x || p.y > region.max.y || p.z > region.max.z) return;
+		}
+		b->ApplyForce(gravity);
+	}
+};
+
+/*
+ * Linear and quadratic drag: F = -(k1 + k2*|v|)*v, angular drag: M = -kAngular*omega
+ */
+class DragGenerator : public ForceGenerator
+{
+public:
+	real k1;
+	real k2;
+	real kAngular;
+
+	DragGenerator(real k1, real k2 = 0, real kAngular = 0)
+	{
+		this->k1 = k1;
+		this->k2 = k2;
+		this->kAngular = kAngular;
+	}
+
+	virtual void Apply(RigidBody* b, real dt)
+	{
+		rvec3 v = b->GetVelocity();
+		b->ApplyForce(-(k1 + k2*length(v)) * v);
+		b->ApplyTorque(-kAngular * b->GetAngularVelocity());
+	}
+};
+
+/*
+ * Wind field: drag relative to the velocity of the air, F = k*(wind - v)
+ */
+class WindGenerator : public ForceGenerator
+{
+public:
+	rvec3 wind;
+	real k;
+
+	WindGenerator(rvec3 wind, real k, rvec3 regionMin, rvec3 regionMax)
+	{
+		this->wind = wind;
+		this->k = k;
+		SetRegion(regionMin, regionMax);
+	}
+
+	virtual void Apply(RigidBody* b, real dt)
+	{
+		b->ApplyForce(k * (wind - b->GetVelocity()));
+	}
+};
+
+/*
+ * Radial explosion, one impulse falling off linearly with the distance to the center
+ */
+class ExplosionGenerator : public ForceGenerator
+{
+public:
+	rvec3 center;
+	real radius;
+	real impulse; // at the center
+
+	ExplosionGenerator(rvec3 center, real radius, real impulse)
+	{
+		this->center = center;
+		this->radius = radius;
+		this->impulse = impulse;
+		SetRegion(center - rvec3(radius), center + rvec3(radius));
+	}
+
+	virtual bool IsOneShot() { return true; }
+	virtual bool WakesBodies() { return true; }
+
+	virtual void Apply(RigidBody* b, real dt)
+	{
+		rvec3 d = b->GetPosition() - center;
+		real distance = length(d);
+		if (distance >= radius) return;
+
+		rvec3 direction = distance > 1e-9 ? d / distance : rvec3(0,1,0);
+		b->ApplyLinearMomentum(direction * impulse * (1 - distance/radius));
+	}
+};
+
+/*
+ * Liquid below a horizontal plane: lift proportional to the submerged part of the body (estimated with the aabb)
+ * and drag inside the liquid
+ */
+class BuoyancyGenerator : public ForceGenerator
+{
+public:
+	real height;	// surface of the liquid (y)
+	real density;	// lift per submerged volume
+	real drag;
+
+	BuoyancyGenerator(real height, real density, real drag = 0.5)
+	{
+		this->height = height;
+		this->density = density;
+		this->drag = drag;
+		SetRegion(rvec3(-FORCE_GENERATOR_INFINITY), rvec3(FORCE_GENERATOR_INFINITY, height, FORCE_GENERATOR_INFINITY));
+	}
+
+	virtual void Apply(RigidBody* b, real dt)
+	{
+		const AABB box = b->GetAABB();
+		rvec3 size = box.max - box.min;
+		if (size.y <= 0) return;
+
+		real submerged = std::min(std::max((height - box.min.y) / size.y, real(0)), real(1));
+		if (submerged == 0) return;
+
+		real volume = size.x * size.y * size.z;
+		b->ApplyForce(rvec3(0, density * volume * submerged, 0) - submerged * drag * b->GetVelocity());
+	}
+};
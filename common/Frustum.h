@@ -0,0 +1,49 @@
+/*
+ * View volume given by a view projection matrix (perspective camera or orthographic light) as six planes,
+ * used to cull the models of a render pass by their world space bounding boxes
+ */
+
+#pragma once
+
+#include <glm/glm.hpp>
+using namespace glm;
+
+class Frustum
+{
+
+private:
+	vec4 planes[6]; // normal pointing inside, dot(normal, p) + w >= 0 for points inside
+
+public:
+
+	// planes from the rows of the clip matrix (Gribb/Hartmann)
+	Frustum(const mat4& viewProjection)
+	{
+		vec4 row[4];
+		for (int i=0; i<4; ++i)
+		{
+			row[i] = vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+		}
+
+		planes[0] = row[3] + row[0]; // left
+		planes[1] = row[3] - row[0]; // right
+		planes[2] = row[3] + row[1]; // bottom
+		planes[3] = row[3] - row[1]; // top
+		planes[4] = row[3] + row[2]; // near
+		planes[5] = row[3] - row[2]; // far
+	}
+
+	// false only if the box is completely outside of one plane (conservative: boxes near the corners pass)
+	bool Intersects(const vec3& min, const vec3& max) const
+	{
+		for (int i=0; i<6; ++i)
+		{
+			const vec4& p = planes[i];
+
+			// corner furthest along the normal
+			vec3 v(p.x >= 0 ? max.x : min.x, p.y >= 0 ? max.y : min.y, p.z >= 0 ? max.z : min.z);
+			if (p.x*v.x + p.y*v.y + p.z*v.z + p.w < 0) return false;
+		}
+		return true;
+	}
+};
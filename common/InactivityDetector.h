@@ -25,14 +25,14 @@ class InactivityDetector
 
 private:
 
-	std::map<int, std::set<RigidBody*>> inactivitySets;
-	std::set<RigidBody*> inactivityChecked;
+	std::map<int, std::set<RigidBody*, RigidBodyIdLess>> inactivitySets;
+	std::set<RigidBody*, RigidBodyIdLess> inactivityChecked;
 
 	//int updateInterval = 30; // recompute only every i-th update
 	//int updateTimer = 0; 
 
-	double updateInterval = 1./2.;
-	double updateTimer = 0;
+	real updateInterval = 1./2.;
+	real updateTimer = 0;
 
 public:
 
@@ -47,6 +47,19 @@ public:
 		inactivityChecked.clear();
 	}
 
+	real GetUpdateTimer() { return updateTimer; }
+	void SetUpdateTimer(real t) { updateTimer = t; }
+
+	// recreates the inactivity sets from the set ids of the inactive bodies (after a snapshot was restored)
+	void RebuildSets(std::vector<RigidBody*>& bodies)
+	{
+		inactivitySets.clear();
+		for (RigidBody* b : bodies)
+		{
+			if (b->inactive) inactivitySets[b->inactiveSetId].insert(b);
+		}
+	}
+
 	// reactivates a body and its inactivity set
 	void Reactivate(RigidBody* a)
 	{
@@ -67,7 +80,7 @@ public:
 	}
 
 	// find inactivity sets
-	void Update(double dt, std::vector<RigidBody*>& bodies)
+	void Update(real dt, std::vector<RigidBody*>& bodies)
 	{
 		updateTimer -= dt;
 		if (updateTimer > 0) return;
@@ -99,7 +112,7 @@ public:
 					if (inactivityChecked.find(a) != inactivityChecked.end()) continue;
 					inactivityChecked.insert(a);
 
-					std::set<RigidBody*> inactiveSet;
+					std::set<RigidBody*, RigidBodyIdLess> inactiveSet;
 					inactiveSet.insert(a);
 
 					if (recurseInactivitySet(a, inactiveSet))
@@ -110,7 +123,7 @@ public:
 			}
 		}
 
-		for (const std::pair<int, std::set<RigidBody*>>& it : inactivitySets)
+		for (const std::pair<int, std::set<RigidBody*, RigidBodyIdLess>>& it : inactivitySets)
 		{
 			for (RigidBody * b : it.second)
 			{
@@ -133,7 +146,7 @@ public:
 
 protected:
 
-	bool recurseInactivitySet(RigidBody* a, std::set<RigidBody*>& currentSet)
+	bool recurseInactivitySet(RigidBody* a, std::set<RigidBody*, RigidBodyIdLess>& currentSet)
 	{
 		for (const std::pair<int, ContactManifold*>& it : a->manifolds)
 		{
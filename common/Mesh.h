@@ -46,6 +46,10 @@ class Mesh {
 
 		ShapeType type;
 
+		// bounding box of the vertices (local coordinates)
+		vec3 boundsMin;
+		vec3 boundsMax;
+
 
     public:
 
@@ -132,11 +136,29 @@ class Mesh {
 		
 		ShapeType GetShapeType(){return type; }
 
+		vec3 GetBoundsMin() { return boundsMin; }
+		vec3 GetBoundsMax() { return boundsMax; }
+
+		// points the instance matrix attributes to another buffer (e.g. the culled instances of a render pass)
+		void SetInstanceBuffer(GLuint buffer)
+		{
+			glBindVertexArray(this->VAO);
+			bindInstanceBuffer(buffer);
+			glBindVertexArray(0);
+		}
+
 
     private:
 
         void setupMesh()
 		{
+			boundsMin = boundsMax = this->vertices.empty() ? vec3(0) : this->vertices[0].Position;
+			for (const Vertex& v : this->vertices)
+			{
+				boundsMin = glm::min(boundsMin, v.Position);
+				boundsMax = glm::max(boundsMax, v.Position);
+			}
+
 			// create buffers
 			glGenVertexArrays(1, &this->VAO);
 			glGenBuffers(1, &this->VBO);
@@ -185,10 +207,22 @@ class Mesh {
 			glBindVertexArray(this->VAO);
 			// create model instance buffer
 			glGenBuffers(1, &this->MBO);
-			glBindBuffer(GL_ARRAY_BUFFER, this->MBO);
+			bindInstanceBuffer(this->MBO);
+
+			glVertexAttribDivisor(4, 1);
+			glVertexAttribDivisor(5, 1);
+			glVertexAttribDivisor(6, 1);
+			glVertexAttribDivisor(7, 1);
 
+			glBindVertexArray(0);
+
+	}
+
+		// model instance matrix (the vertex array has to be bound)
+		void bindInstanceBuffer(GLuint buffer)
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, buffer);
 
-			// model instance matrix
 			glEnableVertexAttribArray(4); 
 			glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (GLvoid*)0);
 			glEnableVertexAttribArray(5); 
@@ -197,15 +231,7 @@ class Mesh {
 			glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (GLvoid*)(2 * sizeof(glm::vec4)));
 			glEnableVertexAttribArray(7); 
 			glVertexAttribPointer(7, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (GLvoid*)(3 * sizeof(glm::vec4)));
-
-			glVertexAttribDivisor(4, 1);
-			glVertexAttribDivisor(5, 1);
-			glVertexAttribDivisor(6, 1);
-			glVertexAttribDivisor(7, 1);
-
-			glBindVertexArray(0);
-
-	}
+		}
 };
 
 // creates some hardcoded meshes
@@ -11,8 +11,21 @@
 using namespace glm;
 
 #include <vector>
+#include <algorithm>
 #include "Entity.h"
 #include "Mesh.h"
+#include "Frustum.h"
+
+// render passes with their own culled instance lists (the dynamic shadow, the color and the static shadow pass)
+#define MODEL_CULL_PASSES 3
+
+// the shadow map is split into a cached layer of the static geometry and a layer of the dynamic geometry
+enum DrawLayer
+{
+	AllLayers,
+	StaticLayer,
+	DynamicLayer
+};
 
 class Model : public Entity
 {
@@ -22,12 +35,46 @@ private:
 	// instancing
 	bool slave = false; // true iff object is instance of other object
 	std::vector<Model*> instances;
+	Model* master = NULL; // of a slave
+	int slot = 0; // index in the model matrices of the master (master: 0, instances: 1..n)
 
 	// rendering
 	bool visible = true;
+	bool staticGeometry = true; // does not move unless moved explicitly
 
-	// model matrices
-	mat4* modelMatrices = NULL; // space for model matrices for all instances
+	// model matrices of the master and all instances
+	std::vector<mat4> modelMatrices;
+	bool matricesSynced = false; // written by the transform sync
+
+	// the matrices stay in the MBO of the mesh, only the changed slots [dirtyBegin, dirtyEnd) are uploaded
+	Mesh* bufferMesh = NULL; // mesh whose MBO holds the matrices
+	size_t bufferCapacity = 0;
+	size_t dirtyBegin = 0;
+	size_t dirtyEnd = 0;
+	unsigned int matricesVersion = 0; // incremented with every change of the matrices
+
+	// culling: the visible instances of a pass are uploaded (compacted) into a buffer of the pass
+	struct CulledInstances
+	{
+		std::vector<int> slots;
+		GLuint buffer = 0;
+		unsigned int version = 0; // of the matrices in the buffer
+		bool valid = false;
+	};
+	CulledInstances culled[MODEL_CULL_PASSES];
+	std::vector<int> visibleSlots;
+	std::vector<mat4> visibleMatrices;
+
+	// static layer: the instances and matrices it was drawn with (to detect changes)
+	std::vector<int> staticSlots;
+	std::vector<mat4> staticMatrices;
+
+	static const Frustum* cullFrustum;
+	static int cullPass;
+
+	static DrawLayer drawLayer;
+	static bool drawStaticLayer; // false: the static layer pass only detects changes
+	static bool staticLayerChanged;
 
 protected:
 
@@ -47,7 +94,58 @@ public:
 	virtual ~Model()
 	{
 		if (!slave && mesh != NULL) delete mesh;		
-		if (modelMatrices != NULL) delete[] modelMatrices;
+		if (!staticSlots.empty()) staticLayerChanged = true;
+		for (CulledInstances& c : culled)
+		{
+			if (c.buffer != 0) glDeleteBuffers(1, &c.buffer);
+		}
+	}
+
+	// models and instances outside of the frustum are not drawn (NULL: no culling, e.g. for the debug pass)
+	static void SetCullFrustum(const Frustum* frustum, int pass = 0)
+	{
+		assert(pass >= 0 && pass < MODEL_CULL_PASSES);
+		cullFrustum = frustum;
+		cullPass = pass;
+	}
+
+	// only the instances of the layer are drawn, the static layer is only drawn if draw is set (otherwise the
+	// pass only checks if the static geometry changed since it was drawn last)
+	static void SetDrawLayer(DrawLayer layer, bool draw = true)
+	{
+		drawLayer = layer;
+		drawStaticLayer = draw;
+	}
+
+	// true if static geometry was added, removed, moved or woke up since the last reset
+	static bool StaticLayerChanged() { return staticLayerChanged; }
+	static void ResetStaticLayerChanged() { staticLayerChanged = false; }
+
+	// static geometry is drawn into the cached static layer of the shadow map
+	virtual bool IsStaticGeometry() { return staticGeometry; }
+
+	void SetStaticGeometry(bool s)
+	{
+		this->staticGeometry = s;
+	}
+
+	// world space bounding box used for culling, false if unknown (never culled)
+	virtual bool GetWorldBounds(vec3& min, vec3& max)
+	{
+		// transformed box of the mesh bounds
+		mat4 M = GetTransformMatrix();
+		vec3 center = (mesh->GetBoundsMin() + mesh->GetBoundsMax()) * 0.5f;
+		vec3 extent = (mesh->GetBoundsMax() - mesh->GetBoundsMin()) * 0.5f;
+
+		vec3 c = vec3(M * vec4(center, 1));
+		vec3 e;
+		for (int i=0; i<3; ++i)
+		{
+			e[i] = std::abs(M[0][i])*extent.x + std::abs(M[1][i])*extent.y + std::abs(M[2][i])*extent.z;
+		}
+		min = c - e;
+		max = c + e;
+		return true;
 	}
 
 	void SetVisible(bool v)
@@ -65,19 +163,62 @@ public:
 		Model* instance = copyAsSlave(pos);
 		instance->scale = scale;
 		instance->rotation = rotation;
+		instance->master = this;
 		instances.push_back(instance);
-
-		// reset model matrix memory
-		if (modelMatrices != NULL) delete[] modelMatrices;
-		modelMatrices = NULL; 
+		instance->slot = instances.size();
 
 		return instance;
 	}
 
+	Model* GetMaster() { return slave ? master : this; }
+	int GetInstanceSlot() { return slot; }
+	int GetInstanceCount() { return instances.size(); }
+
+	// model matrices of the master and all its instances (indexed by the instance slot), only for the master
+	mat4* GetInstanceMatrices()
+	{
+		assert(slave == false);
+		resizeMatrices();
+		return &modelMatrices[0];
+	}
+
+	// the transform sync writes all instance matrices, the draw does not gather them
+	void SetMatricesSynced(bool synced)
+	{
+		matricesSynced = synced;
+	}
+
+	// the matrices of the slots [begin, end) changed and are uploaded with the next draw
+	void MarkInstancesDirty(size_t begin, size_t end)
+	{
+		if (begin >= end) return;
+		matricesVersion++;
+		if (dirtyBegin >= dirtyEnd)
+		{
+			dirtyBegin = begin;
+			dirtyEnd = end;
+		}
+		else
+		{
+			dirtyBegin = std::min(dirtyBegin, begin);
+			dirtyEnd = std::max(dirtyEnd, end);
+		}
+	}
+
 	
 	virtual void Draw(Shader& shader)
 	{
-		if (!visible) return;
+		if (!visible)
+		{
+			// hidden models do not cast shadows into the static layer anymore
+			if (drawLayer == StaticLayer && !staticSlots.empty())
+			{
+				staticSlots.clear();
+				staticMatrices.clear();
+				staticLayerChanged = true;
+			}
+			return;
+		}
 
 		Entity::Draw(shader);
 
@@ -85,36 +226,155 @@ public:
 
 		size_t n = instances.size() + 1; // plus one for the current instance
 
-		if (n > 1)
+		// we are master and render all instances of the current object
+		// (the transform sync might have written the matrices already)
+		resizeMatrices();
+		if (!matricesSynced)
 		{
-			// reserve memory for model matrices of all instances 
-			if (modelMatrices == NULL) modelMatrices = new mat4[n];
-
-			// we are master and render all instances of the current object
+			gatherMatrix(0, GetTransformMatrix());
 			for (int i = 0; i<n-1; ++i)
 			{
-				modelMatrices[i] = instances[i]->GetTransformMatrix();
+				gatherMatrix(i+1, instances[i]->GetTransformMatrix());
 			}
-			modelMatrices[n-1] = GetTransformMatrix();
-			
-			glBindBuffer(GL_ARRAY_BUFFER, mesh->MBO);
-			glBufferData(GL_ARRAY_BUFFER, n * sizeof(glm::mat4), &modelMatrices[0], GL_STATIC_DRAW);
 		}
-		else
+
+		if (drawLayer == StaticLayer && !drawStaticLayer)
+		{
+			detectStaticChanges();
+			return;
+		}
+
+		if ((cullFrustum != NULL || drawLayer != AllLayers) && cull())
 		{
-			// we have no instances, render just this object
-			mat4 M = GetTransformMatrix();
-			glBindBuffer(GL_ARRAY_BUFFER, mesh->MBO);
-			glBufferData(GL_ARRAY_BUFFER, sizeof(glm::mat4), &M[0], GL_STATIC_DRAW);
+			drawCulled(shader);
+			return;
 		}
 
+		uploadMatrices();
+
 		mesh->Draw(shader, n);
 	}
 
 
+private:
+
+	// collects the visible slots of the layer, true if some are culled
+	bool cull()
+	{
+		size_t n = instances.size() + 1;
+		visibleSlots.clear();
+		for (size_t i=0; i<n; ++i)
+		{
+			Model* m = i == 0 ? this : instances[i-1];
+			if (drawLayer != AllLayers && m->IsStaticGeometry() != (drawLayer == StaticLayer)) continue;
+
+			vec3 min, max;
+			if (cullFrustum == NULL || !m->GetWorldBounds(min, max) || cullFrustum->Intersects(min, max)) visibleSlots.push_back(i);
+		}
+		return visibleSlots.size() < n;
+	}
+
+	// compares the static instances and their matrices with the ones the static layer was drawn with
+	void detectStaticChanges()
+	{
+		cull();
+
+		bool changed = visibleSlots != staticSlots;
+		for (size_t i=0; i<visibleSlots.size() && !changed; ++i)
+		{
+			changed = !(modelMatrices[visibleSlots[i]] == staticMatrices[i]);
+		}
+		if (!changed) return;
+
+		staticSlots = visibleSlots;
+		staticMatrices.resize(staticSlots.size());
+		for (size_t i=0; i<staticSlots.size(); ++i)
+		{
+			staticMatrices[i] = modelMatrices[staticSlots[i]];
+		}
+		staticLayerChanged = true;
+	}
+
+	// draws the visible instances from the buffer of the pass (uploaded only if they or their matrices changed)
+	void drawCulled(Shader& shader)
+	{
+		if (visibleSlots.empty()) return;
+
+		CulledInstances& c = culled[cullPass];
+		if (c.buffer == 0) glGenBuffers(1, &c.buffer);
+
+		if (!c.valid || c.version != matricesVersion || c.slots != visibleSlots)
+		{
+			visibleMatrices.resize(visibleSlots.size());
+			for (size_t i=0; i<visibleSlots.size(); ++i)
+			{
+				visibleMatrices[i] = modelMatrices[visibleSlots[i]];
+			}
+
+			glBindBuffer(GL_ARRAY_BUFFER, c.buffer);
+			glBufferData(GL_ARRAY_BUFFER, visibleMatrices.size() * sizeof(glm::mat4), &visibleMatrices[0], GL_DYNAMIC_DRAW);
+
+			c.slots.swap(visibleSlots);
+			c.version = matricesVersion;
+			c.valid = true;
+		}
+
+		mesh->SetInstanceBuffer(c.buffer);
+		mesh->Draw(shader, c.slots.size());
+		mesh->SetInstanceBuffer(mesh->MBO);
+	}
+
+	// new slots are uploaded with the next draw
+	void resizeMatrices()
+	{
+		size_t n = instances.size() + 1;
+		size_t old = modelMatrices.size();
+		if (old == n) return;
+
+		modelMatrices.resize(n);
+		MarkInstancesDirty(old, n);
+	}
+
+	void gatherMatrix(size_t slot, const mat4& M)
+	{
+		if (modelMatrices[slot] == M) return;
+		modelMatrices[slot] = M;
+		MarkInstancesDirty(slot, slot+1);
+	}
+
+	void uploadMatrices()
+	{
+		size_t n = modelMatrices.size();
+		glBindBuffer(GL_ARRAY_BUFFER, mesh->MBO);
+
+		// (re)allocate the buffer, it grows by doubling s.t. adding instances does not reallocate every time
+		if (bufferMesh != mesh || bufferCapacity < n)
+		{
+			bufferCapacity = bufferMesh == mesh ? std::max(n, 2*bufferCapacity) : n;
+			bufferMesh = mesh;
+			glBufferData(GL_ARRAY_BUFFER, bufferCapacity * sizeof(glm::mat4), NULL, GL_DYNAMIC_DRAW);
+			dirtyBegin = 0;
+			dirtyEnd = n;
+		}
+
+		if (dirtyBegin < dirtyEnd)
+		{
+			glBufferSubData(GL_ARRAY_BUFFER, dirtyBegin * sizeof(glm::mat4), (dirtyEnd - dirtyBegin) * sizeof(glm::mat4), &modelMatrices[dirtyBegin]);
+		}
+		dirtyBegin = 0;
+		dirtyEnd = 0;
+	}
+
 protected:
 	virtual Model* copyAsSlave(vec3 pos)
 	{
 		return new Model(mesh, pos, true);
 	}
 };
+
+const Frustum* Model::cullFrustum = NULL;
+int Model::cullPass = 0;
+
+DrawLayer Model::drawLayer = AllLayers;
+bool Model::drawStaticLayer = true;
+bool Model::staticLayerChanged = false;
@@ -12,6 +12,7 @@ using namespace glm;
 
 #include <vector>
 #include <list>
+#include <cstdint>
 #include <unordered_map>
 #include <functional>
 #include <iostream>
@@ -29,6 +30,13 @@ using namespace glm;
 #include "constraint/HingeConstraint.h"
 #include "constraint/BallJointConstraint.h"
 #include "constraint/SoftDistanceConstraint.h"
+#include "Articulation.h"
+#include "ForceGenerator.h"
+#include "PhysicSnapshot.h"
+#include "ReplayRecorder.h"
+#ifdef PLATFORM_DESKTOP
+#include "SharedTransformExporter.h" // posix shared memory (not available on android)
+#endif
 
 //#define TIMING
 #ifdef TIMING
@@ -40,6 +48,14 @@ using namespace glm;
 #define CONSTRAINTSOLVINGITERATIONS 4
 #define TIMPESTEPDIVIDER 4
 #define SPEEDUP 2
+#define SPECULATIVE_MARGIN 0.02 // min distance at which speculative contacts are created
+
+enum SteppingMode
+{
+	SequentialImpulses, // collision detection and all solver iterations in every substep
+	TemporalGaussSeidel, // collision detection once per frame, one solver iteration and a relaxation per substep
+	PositionBasedDynamics // XPBD: collision detection and one position projection of the constraints per substep, velocities from the position change
+};
 
 class PhysicManager
 {
@@ -50,16 +66,49 @@ private:
 
 	int timestepDivider = TIMPESTEPDIVIDER;
 	int speedup = SPEEDUP;
+	SteppingMode steppingMode = SequentialImpulses;
+	bool speculativeContacts = false;
+	bool deterministic = false;
+	uint64_t stateChecksum = 0;
 
 	InactivityDetector* inactivityDetector;
 	CollisionDetector* collisionDetector;
 	ConstraintSolver* constraintSolver;
+
+	std::vector<Articulation*> articulations;
+
+	rvec3 gravity = rvec3(0,-GRAVITY,0);
+	std::vector<ForceGenerator*> forceGenerators;
+
+	ReplayRecorder* recorder = NULL; // not owned
+	#ifdef PLATFORM_DESKTOP
+	SharedTransformExporter* exporter = NULL; // not owned
+	#endif
+
+	std::vector<RigidBody*> bodyById; // scratch of RestoreSnapshot
+	std::vector<bool> bodyInSnapshot; // scratch of RestoreSnapshot
+	std::vector<std::pair<std::pair<int,int>, ContactManifold*>> snapshotManifolds; // scratch of SaveSnapshot
 	
 public: 
 	
 	void SetSpeedup(int i) { speedup = i; }
 	void SetTimestepDivider(int i) { timestepDivider = i; }
 	void SetConstraintSolvingInterations(int i) { constraintSolver->SetIterations(i); }
+	void SetSteppingMode(SteppingMode m) { steppingMode = m; }
+	SteppingMode GetSteppingMode() { return steppingMode; }
+	void SetSpeculativeContacts(bool enabled) { speculativeContacts = enabled; }
+	void SetSplitImpulse(bool enabled) { constraintSolver->SetSplitImpulse(enabled); }
+	void SetBlockSolver(bool enabled) { constraintSolver->SetBlockSolver(enabled); }
+	void SetConstraintSolverType(ConstraintSolverType t) { constraintSolver->SetSolverType(t); } // iterations of the sequential impulses stepping
+	ConstraintSolverType GetConstraintSolverType() { return constraintSolver->GetSolverType(); }
+	void SetShockPropagation(bool enabled) { constraintSolver->SetShockPropagation(enabled); } // for tall stacks
+	void SetConstraintSolvingTolerance(real tolerance, int minIterations) { constraintSolver->SetTolerance(tolerance); constraintSolver->SetMinIterations(minIterations); }
+	// stable (id based) order of the contacts and islands, identical inputs give bit identical results at any thread count
+	void SetDeterministic(bool enabled) { deterministic = enabled; constraintSolver->SetDeterministic(enabled); }
+	bool IsDeterministic() { return deterministic; }
+	uint64_t GetStateChecksum() { return stateChecksum; } // of the state after the last Update (deterministic mode only)
+	int GetConstraintSolvingIterationsUsed() { return constraintSolver->GetUsedIterations(); }
+	real GetConstraintSolvingResidual() { return constraintSolver->GetResidual(); }
 
 	PhysicManager()
 	{
@@ -78,6 +127,8 @@ public:
 		delete collisionDetector;
 		delete constraintSolver;
 		delete inactivityDetector;
+		clearArticulations();
+		clearForceGenerators();
 	}
 
 	bool IsRunning()
@@ -85,11 +136,59 @@ public:
 		return running;
 	}
 
+	// the built in constraint types are stored by value (c is copied), the handle gives access to them
+	template<typename T>
+	typename std::enable_if<IsRegisteredConstraint<T>::value, ConstraintHandle<T>>::type AddConstraint(const T& c)
+	{
+		return constraintSolver->AddConstraint(c);
+	}
+
+	template<typename T>
+	typename std::enable_if<IsRegisteredConstraint<T>::value>::type AddConstraint(T* c) = delete;
+
+	// other constraints are owned by the solver
 	void AddConstraint(Constraint* c)
 	{
 		constraintSolver->AddConstraint(c);
 	}
 
+	template<typename T>
+	T& GetConstraint(ConstraintHandle<T> handle)
+	{
+		return constraintSolver->GetConstraint(handle);
+	}
+
+	// the bodies of the articulation need to be added with AddBody as well, the physic manager takes the ownership
+	void AddArticulation(Articulation* a)
+	{
+		articulations.push_back(a);
+	}
+
+	// evaluated for all dynamic bodies in every substep, the physic manager takes the ownership
+	void AddForceGenerator(ForceGenerator* g)
+	{
+		forceGenerators.push_back(g);
+	}
+
+	void RemoveForceGenerator(ForceGenerator* g)
+	{
+		forceGenerators.erase(std::remove(forceGenerators.begin(), forceGenerators.end(), g), forceGenerators.end());
+		delete g;
+	}
+
+	// every Update is recorded as one frame, NULL stops the recording (the physic manager does not own the recorder)
+	void SetReplayRecorder(ReplayRecorder* r) { recorder = r; }
+	ReplayRecorder* GetReplayRecorder() { return recorder; }
+
+	#ifdef PLATFORM_DESKTOP
+	// the transforms of every Update are published to shared memory, NULL stops the export (not owned)
+	void SetTransformExporter(SharedTransformExporter* e) { exporter = e; }
+	SharedTransformExporter* GetTransformExporter() { return exporter; }
+	#endif
+
+	void SetGravity(rvec3 g) { gravity = g; }
+	rvec3 GetGravity() { return gravity; }
+
 	void AddBody(RigidBody* body)
 	{
 		this->bodies.push_back(body);
@@ -108,11 +207,26 @@ public:
 		collisionDetector->Clear();
 		inactivityDetector->Clear();
 		constraintSolver->Clear();
+		clearArticulations();
+		clearForceGenerators();
 
 		// reset previous values to default values
 		constraintSolver->SetIterations(CONSTRAINTSOLVINGITERATIONS);
+		constraintSolver->SetSplitImpulse(false);
+		constraintSolver->SetBlockSolver(false);
+		constraintSolver->SetSolverType(ProjectedGaussSeidel);
+		constraintSolver->SetShockPropagation(false);
+		constraintSolver->SetTolerance(SOLVER_TOLERANCE);
+		constraintSolver->SetMinIterations(SOLVER_MIN_ITERATIONS);
 		timestepDivider = TIMPESTEPDIVIDER;
 		speedup = SPEEDUP;
+		steppingMode = SequentialImpulses;
+		speculativeContacts = false;
+		SetDeterministic(false);
+		if (recorder != NULL) recorder->ResetBodyTable(); // not owned, keeps recording the new bodies
+		// the exporter (not owned) stays attached and publishes the new bodies
+		stateChecksum = 0;
+		gravity = rvec3(0,-GRAVITY,0);
 	}
 
 	void Stabilize(GLfloat T)
@@ -153,36 +267,120 @@ public:
 		int n = bodies.size();
 		if (n == 0) return;
 
+		wakeUpForceGeneratorRegions();
+
 		#ifdef TIMING
-		Timer t1, t2, t3, t4, t5;
+		Timer t1, t3, t4, t5, t6;
 		#endif
 
-		while (t < T)
+		if (steppingMode == TemporalGaussSeidel)
 		{
+			// contacts are only searched once, during the substeps they are moved with the bodies
 			#ifdef TIMING
-			t1.start();
-			#endif
-			integrateEulerAtCurrentState(h); // wolftho: I think this is equivalent to having the to seperate integrations, thomaset: that's true as indeed..., as long the velocity is integrated first
-			#ifdef TIMING
-			t1.stop();
-			t2.start();
-			#endif
-			calculateExternalForcesAndTorque(h);
-			#ifdef TIMING
-			t2.stop();
 			t3.start();
 			#endif
+			updateSpeculativeMargins(T);
 			collisionDetector->FindCollisions();
 			#ifdef TIMING
 			t3.stop();
-			t4.start();
-			#endif
-			constraintSolver->Solve(h, collisionDetector->activeContactManifolds);
-			#ifdef TIMING
-			t4.stop();
 			#endif
 
-			t += h;
+			while (t < T)
+			{
+				#ifdef TIMING
+				t1.start();
+				#endif
+				integrateVelocitiesAtCurrentState(h);
+				integrateArticulations(h);
+				#ifdef TIMING
+				t1.stop();
+				t4.start();
+				#endif
+				constraintSolver->SolveSubstep(h, collisionDetector->activeContactManifolds);
+				applyArticulationImpulses();
+				#ifdef TIMING
+				t4.stop();
+				t1.start();
+				#endif
+				integratePositionsAtCurrentState(h);
+				#ifdef TIMING
+				t1.stop();
+				t4.start();
+				#endif
+				constraintSolver->Relax(h);
+				applyArticulationImpulses();
+				#ifdef TIMING
+				t4.stop();
+				#endif
+
+				t += h;
+			}
+		}
+		else if (steppingMode == PositionBasedDynamics)
+		{
+			while (t < T)
+			{
+				#ifdef TIMING
+				t1.start();
+				#endif
+				integrateArticulations(h);
+				integratePredictedPositions(h);
+				#ifdef TIMING
+				t1.stop();
+				t3.start();
+				#endif
+				updateSpeculativeMargins(h);
+				collisionDetector->FindCollisions();
+				#ifdef TIMING
+				t3.stop();
+				t4.start();
+				#endif
+				constraintSolver->Project(h, collisionDetector->activeContactManifolds);
+				#ifdef TIMING
+				t4.stop();
+				t1.start();
+				#endif
+				updateVelocitiesFromPositions(h);
+				#ifdef TIMING
+				t1.stop();
+				t4.start();
+				#endif
+				constraintSolver->SolveVelocities(h);
+				applyArticulationImpulses();
+				#ifdef TIMING
+				t4.stop();
+				#endif
+
+				t += h;
+			}
+		}
+		else
+		{
+			while (t < T)
+			{
+				#ifdef TIMING
+				t1.start();
+				#endif
+				integrateArticulations(h);
+				integrateEulerAtCurrentState(h); // wolftho: I think this is equivalent to having the to seperate integrations, thomaset: that's true as indeed..., as long the velocity is integrated first
+				#ifdef TIMING
+				t1.stop();
+				t3.start();
+				#endif
+				updateSpeculativeMargins(h);
+				collisionDetector->FindCollisions();
+				#ifdef TIMING
+				t3.stop();
+				t4.start();
+				#endif
+				constraintSolver->Solve(h, collisionDetector->activeContactManifolds);
+				applyArticulationImpulses();
+				#ifdef TIMING
+				t4.stop();
+				#endif
+
+				t += h;
+			}
 		}
 
 		#ifdef TIMING
@@ -192,20 +390,90 @@ public:
 		#ifdef TIMING
 		t5.stop();
 		#endif
+
+		if (deterministic) stateChecksum = computeStateChecksum();
+
+		#ifdef TIMING
+		t6.start();
+		#endif
+		if (recorder != NULL) recorder->Record(bodies, collisionDetector->activeContactManifolds, T);
+		#ifdef PLATFORM_DESKTOP
+		if (exporter != NULL) exporter->Publish(bodies, T);
+		#endif
+		#ifdef TIMING
+		t6.stop();
+		#endif
 		
 		#ifdef TIMING
 		std::cout << std::setprecision(6) << std::fixed;
-		std::cout << "Timing velocity integrator:    " << t1.mean() << std::endl;
-		std::cout << "Timing ext forces:             " << t2.mean() << std::endl;
+		std::cout << "Timing integrator, ext forces: " << t1.mean() << std::endl;
 		std::cout << "Timing find constacts:         " << t3.mean() << std::endl;
 		std::cout << "Timing resolve constraints:    " << t4.mean() << std::endl;
 		std::cout << "Timing inactivity detector:    " << t5.mean() << std::endl;
+		std::cout << "Timing recorder/export:        " << t6.mean() << std::endl;
+		std::cout << "Solver iterations/residual:    " << constraintSolver->GetUsedIterations() << " / " << constraintSolver->GetResidual()
+		          << " (" << constraintSolver->GetIslandCount() << " islands)" << std::endl;
+		if (deterministic) std::cout << "State checksum:                " << std::hex << stateChecksum << std::dec << std::endl;
 		std::cout << std::endl;
 		#endif
 		
 		drawDebugInformation();
 	}
 
+	// captures the simulation state, it can be restored into this world (same bodies and constraints) any time later
+	// (continuing from a restored snapshot gives bit identical results in the deterministic mode)
+	void SaveSnapshot(PhysicSnapshot& s)
+	{
+		s.Clear();
+
+		s.bodies.resize(bodies.size());
+		for (size_t i=0; i<bodies.size(); ++i)
+		{
+			bodies[i]->SaveState(s.bodies[i]);
+		}
+
+		saveManifolds(s);
+
+		constraintSolver->SaveImpulses(s.constraintImpulses);
+
+		for (Articulation* a : articulations)
+		{
+			a->SaveState(s.links);
+		}
+
+		s.inactivityTimer = inactivityDetector->GetUpdateTimer();
+	}
+
+	// returns false (and changes nothing) if the snapshot does not fit the bodies and constraints of this world
+	bool RestoreSnapshot(const PhysicSnapshot& s)
+	{
+		int links = 0;
+		for (Articulation* a : articulations) links += a->GetNumberOfLinks();
+
+		if (s.bodies.size() != bodies.size() || (int)s.links.size() != links) return false;
+		if ((int)s.constraintImpulses.size() != constraintSolver->CountPersistentConstraints()) return false;
+		if (!snapshotFits(s)) return false;
+
+		for (const BodyState& state : s.bodies)
+		{
+			bodyById[state.id]->RestoreState(state);
+		}
+
+		restoreManifolds(s);
+
+		constraintSolver->RestoreImpulses(s.constraintImpulses);
+
+		int next = 0;
+		for (Articulation* a : articulations)
+		{
+			next = a->RestoreState(s.links, next);
+		}
+
+		inactivityDetector->SetUpdateTimer(s.inactivityTimer);
+		inactivityDetector->RebuildSets(bodies);
+		return true;
+	}
+
 	void Stop() { running = false; }
 	void Start() { running = true; }
 	
@@ -249,7 +517,118 @@ public:
 	}
 private:
 
-	void integrateEulerAtCurrentState(double h)
+	// all cached manifolds (sorted by the pair of body ids, s.t. equal states give equal snapshots) with their contacts
+	void saveManifolds(PhysicSnapshot& s)
+	{
+		snapshotManifolds.assign(collisionDetector->contactManifolds.begin(), collisionDetector->contactManifolds.end());
+		std::sort(snapshotManifolds.begin(), snapshotManifolds.end());
+
+		for (std::pair<std::pair<int,int>, ContactManifold*>& i : snapshotManifolds)
+		{
+			ContactManifold* m = i.second;
+			std::unordered_map<int, ContactManifold*>::iterator ref = m->bodyA->manifolds.find(m->bodyB->id);
+
+			ManifoldState ms;
+			ms.bodyA = m->bodyA->id;
+			ms.bodyB = m->bodyB->id;
+			ms.normal = m->normal;
+			ms.contactCount = m->contacts.size();
+			ms.persistent = m->persistent;
+			ms.active = collisionDetector->activeContactManifolds.count(i.first) > 0;
+			ms.referenced = ref != m->bodyA->manifolds.end() && ref->second == m;
+			s.manifolds.push_back(ms);
+
+			for (Contact* c : m->contacts)
+			{
+				ContactState cs;
+				c->constraint->SaveState(cs);
+				s.contacts.push_back(cs);
+			}
+		}
+	}
+
+	// true if every body of this world is in the snapshot once (matched by id), the bodies of the manifolds exist
+	// and the contacts add up (builds bodyById)
+	bool snapshotFits(const PhysicSnapshot& s)
+	{
+		bodyById.clear();
+		for (RigidBody* b : bodies)
+		{
+			if (b->id >= (int)bodyById.size()) bodyById.resize(b->id + 1, NULL);
+			bodyById[b->id] = b;
+		}
+
+		// same number of states as bodies, so no id may be missing or repeated
+		bodyInSnapshot.assign(bodyById.size(), false);
+		for (const BodyState& state : s.bodies)
+		{
+			if (state.id < 0 || state.id >= (int)bodyById.size() || bodyById[state.id] == NULL) return false;
+			if (bodyInSnapshot[state.id]) return false;
+			bodyInSnapshot[state.id] = true;
+		}
+
+		size_t contacts = 0;
+		for (const ManifoldState& ms : s.manifolds)
+		{
+			if (ms.bodyA < 0 || ms.bodyA >= (int)bodyById.size() || bodyById[ms.bodyA] == NULL) return false;
+			if (ms.bodyB < 0 || ms.bodyB >= (int)bodyById.size() || bodyById[ms.bodyB] == NULL) return false;
+			if (ms.bodyA == ms.bodyB || ms.contactCount < 0) return false;
+			contacts += ms.contactCount;
+		}
+		return contacts == s.contacts.size();
+	}
+
+	// replaces the manifolds of the collision detector (they go back to the pools) with the ones of the snapshot
+	// (the snapshot has to fit, see snapshotFits)
+	void restoreManifolds(const PhysicSnapshot& s)
+	{
+		for (std::pair<const std::pair<int,int>, ContactManifold*>& i : collisionDetector->contactManifolds)
+		{
+			ContactManifoldPool::GetInstance().Recycle(i.second);
+		}
+		collisionDetector->contactManifolds.clear();
+		collisionDetector->activeContactManifolds.clear();
+
+		for (RigidBody* b : bodies)
+		{
+			b->manifolds.clear();
+		}
+
+		int next = 0;
+		for (const ManifoldState& ms : s.manifolds)
+		{
+			RigidBody* a = bodyById[ms.bodyA];
+			RigidBody* b = bodyById[ms.bodyB];
+
+			ContactManifold* m = ContactManifoldPool::GetInstance().Get();
+			m->bodyA = a;
+			m->bodyB = b;
+			m->normal = ms.normal;
+			m->persistent = ms.persistent;
+
+			for (int k=0; k<ms.contactCount; ++k)
+			{
+				Contact* c = ContactPool::GetInstance().Get();
+				c->bodyA = a;
+				c->bodyB = b;
+				c->constraint->RestoreState(s.contacts[next++]);
+				m->contacts.push_back(c);
+			}
+
+			std::pair<int,int> pairIndex = collisionDetector->getPairIndex(a, b);
+			collisionDetector->contactManifolds[pairIndex] = m;
+			if (ms.active) collisionDetector->activeContactManifolds[pairIndex] = m;
+			if (ms.referenced)
+			{
+				a->manifolds[b->id] = m;
+				b->manifolds[a->id] = m;
+			}
+		}
+	}
+
+	// the integration passes are fused with the external forces of the next substep (and the aabb refit inside the
+	// integration), s.t. the state of a body goes through the cache once per substep
+	void integrateEulerAtCurrentState(real h)
 	{
 		int n = bodies.size();
 		#pragma omp parallel for
@@ -257,9 +636,11 @@ private:
 		{
 			RigidBody* b = bodies[i];
 			b->IntegrationStep(h);	
+			applyExternalForces(b, h);
 		}
+		removeOneShotForceGenerators();
 	}
-	void integrateVelocitiesAtCurrentState(double h)
+	void integrateVelocitiesAtCurrentState(real h)
 	{
 		int n = bodies.size();
 		#pragma omp parallel for
@@ -269,7 +650,7 @@ private:
 			b->IntegrationStepVelocities(h);	
 		}
 	}
-	void integratePositionsAtCurrentState(double h)
+	void integratePositionsAtCurrentState(real h)
 	{
 		int n = bodies.size();
 		#pragma omp parallel for
@@ -277,10 +658,120 @@ private:
 		{
 			RigidBody* b = bodies[i];
 			b->IntegrationStepPositions(h);	
+			applyExternalForces(b, h);
+		}
+		removeOneShotForceGenerators();
+	}
+
+	// position based dynamics: saves the pose and predicts the new one
+	void integratePredictedPositions(real h)
+	{
+		int n = bodies.size();
+		#pragma omp parallel for
+		for (int i=0; i<n; ++i)
+		{
+			RigidBody* b = bodies[i];
+			b->IntegrationStepXPBD(h);
+		}
+	}
+	void updateVelocitiesFromPositions(real h)
+	{
+		int n = bodies.size();
+		#pragma omp parallel for
+		for (int i=0; i<n; ++i)
+		{
+			RigidBody* b = bodies[i];
+			b->UpdateVelocitiesXPBD(h);
+			applyExternalForces(b, h);
+		}
+		removeOneShotForceGenerators();
+	}
+
+	// articulated bodies are integrated in joint coordinates
+	void integrateArticulations(real h)
+	{
+		for (Articulation* a : articulations)
+		{
+			a->Integrate(h);
+		}
+	}
+
+	// the impulses of the constraint solver (contacts, joints to other bodies) are distributed over the articulations
+	void applyArticulationImpulses()
+	{
+		for (Articulation* a : articulations)
+		{
+			a->ApplyImpulses();
+		}
+	}
+
+	void clearArticulations()
+	{
+		for (Articulation* a : articulations)
+		{
+			delete a;
+		}
+		articulations.clear();
+	}
+
+	// forces used by the integration of the next substep
+	inline void applyExternalForces(RigidBody* b, real h)
+	{
+		b->force = gravity;
+		b->torque = rvec3(0);
+
+		if (b->isStatic || b->inactive) return;
+
+		for (ForceGenerator* g : forceGenerators)
+		{
+			// spatial culling of local generators
+			if (g->local && !g->region.IntersectsWith(b->aabb)) continue;
+			g->Apply(b, h);
+		}
+	}
+
+	// bodies hit by generators that wake them up are reactivated before the step (not thread safe, not in the parallel pass)
+	void wakeUpForceGeneratorRegions()
+	{
+		for (ForceGenerator* g : forceGenerators)
+		{
+			if (!g->WakesBodies()) continue;
+
+			for (RigidBody* b : bodies)
+			{
+				if (b->isStatic) continue;
+				if (g->local && !g->region.IntersectsWith(b->aabb)) continue;
+
+				inactivityDetector->Reactivate(b);
+				b->RevalidateSleeping();
+			}
 		}
 	}
 
-	void calculateExternalForcesAndTorque(double dt)
+	// one shot generators are applied in the first substep only
+	void removeOneShotForceGenerators()
+	{
+		std::vector<ForceGenerator*>::iterator end = std::stable_partition(forceGenerators.begin(), forceGenerators.end(), isPersistent);
+		for (std::vector<ForceGenerator*>::iterator it = end; it != forceGenerators.end(); ++it)
+		{
+			delete *it;
+		}
+		forceGenerators.erase(end, forceGenerators.end());
+	}
+
+	static bool isPersistent(ForceGenerator* g) { return !g->IsOneShot(); }
+
+	void clearForceGenerators()
+	{
+		for (ForceGenerator* g : forceGenerators)
+		{
+			delete g;
+		}
+		forceGenerators.clear();
+	}
+
+	// margin covers the distance a body can move until the contacts are computed again
+	void updateSpeculativeMargins(real dt)
 	{
 		int n = bodies.size();
 
@@ -288,14 +779,48 @@ private:
 		for (int i=0; i<n; ++i)
 		{
 			RigidBody* b = bodies[i];
-			b->force = dvec3(0,-GRAVITY, 0);
-			b->torque = dvec3(0);
+
+			if (!speculativeContacts)
+			{
+				b->speculativeMargin = 0;
+				continue;
+			}
+
+			real radius = 0.5*length(b->aabb.GetScale());
+			b->speculativeMargin = SPECULATIVE_MARGIN + dt*(length(b->velocity) + radius*length(b->angularVelocity));
 		}
 	}
 
-	double getStabilityAverage()
+	// FNV-1a over the bit patterns of the state of all bodies (sequential, in the order the bodies were added)
+	uint64_t computeStateChecksum()
 	{
-		double v = 0;
+		uint64_t hash = 14695981039346656037ULL;
+		for (RigidBody* b : bodies)
+		{
+			hashBytes(hash, &b->position[0], 3*sizeof(real));
+			hashBytes(hash, &b->rotation[0], 4*sizeof(real));
+			hashBytes(hash, &b->linearMomentum[0], 3*sizeof(real));
+			hashBytes(hash, &b->angularMomentum[0], 3*sizeof(real));
+
+			unsigned char flags = (b->sleeping ? 1 : 0) | (b->inactive ? 2 : 0);
+			hashBytes(hash, &flags, 1);
+		}
+		return hash;
+	}
+
+	static void hashBytes(uint64_t& hash, const void* data, size_t size)
+	{
+		const unsigned char* bytes = (const unsigned char*)data;
+		for (size_t i=0; i<size; ++i)
+		{
+			hash ^= bytes[i];
+			hash *= 1099511628211ULL;
+		}
+	}
+
+	real getStabilityAverage()
+	{
+		real v = 0;
 		for (RigidBody* b: bodies)
 		{
 			v += std::pow(b->changeAverage, 2);
@@ -306,18 +831,21 @@ private:
 
 	void drawDebugInformation()
 	{
+		DebugRenderer* debug = DebugRenderer::Instance();
+		if (!debug->IsEnabled()) return;
+
+		// the contact type is the one of the last solve (the contacts are not updated for drawing)
 		for (std::pair<const std::pair<int,int>, ContactManifold*>& i : collisionDetector->activeContactManifolds)
 		{
 			for (Contact* c : i.second->contacts)
 			{
-				c->Update();
-
-				dvec3 color(0,0,1);
-				if (c->type == ContactType::Colliding) color = dvec3(1,0,0);
+				rvec3 color(0,0,1);
+				if (c->type == ContactType::Colliding) color = rvec3(1,0,0);
+				if (c->speculative) color = rvec3(0,1,0);
 
 				int size = 15;
-				DebugRenderer::Instance()->AddDebugPoint(c->location, color, size);
-				DebugRenderer::Instance()->AddDebugPoint(c->locationB, color, size);
+				debug->AddDebugPoint(c->location, color, size);
+				debug->AddDebugPoint(c->locationB, color, size);
 			}
 		}
 
@@ -332,7 +860,7 @@ private:
 			{
 				color = vec3(0,0,1);
 			}
-			DebugRenderer::Instance()->AddDebugBox(a->aabb.GetPosition(), color, a->aabb.GetScale());
+			debug->AddDebugBox(a->aabb.GetPosition(), color, a->aabb.GetScale());
 		}
 	}
 
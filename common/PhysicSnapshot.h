@@ -0,0 +1,206 @@
+/*
+ * Binary snapshot of the simulation state of a PhysicManager (bodies, contact manifolds with the accumulated
+ * impulses, constraint impulses, sleeping/inactivity and articulation state)
+ * Only valid for the world it was taken from: the bodies are matched by id, the shapes, constraints and
+ * settings are not part of the snapshot
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstring>
+#include <cstdint>
+
+#include "Precision.h"
+
+#define SNAPSHOT_MAGIC 0x4e534850 // "PHSN"
+#define SNAPSHOT_VERSION 2
+
+// all states are plain data, restoring them is a memcpy into the (reused) arrays of the snapshot
+
+struct BodyState
+{
+	int id; // the body it is restored into
+	rvec3 position;
+	rquat rotation;
+	rvec3 linearMomentum;
+	rvec3 angularMomentum;
+	rmat3 inertiaTensorInverse;
+	rvec3 velocity;
+	rvec3 angularVelocity;
+	rvec3 force;
+	rvec3 torque;
+	rvec3 pseudoVelocity;
+	rvec3 pseudoAngularVelocity;
+	rvec3 previousPosition;
+	rquat previousRotation;
+	real changeAverage;
+	real speculativeMargin;
+	int inactiveSetId;
+	bool sleeping;
+	bool inactive;
+	bool forceWakeup;
+	bool grounded;
+};
+
+struct ManifoldState
+{
+	int bodyA; // ids
+	int bodyB;
+	rvec3 normal;
+	int contactCount; // the contacts of the manifolds are stored one after another
+	bool persistent;
+	bool active; // in the active manifolds of the collision detector
+	bool referenced; // in the manifold maps of the bodies
+};
+
+struct ContactState
+{
+	rvec3 normal;
+	rvec3 location;
+	rvec3 localLocation;
+	rvec3 locationB;
+	rvec3 localLocationB;
+	rvec3 tangent1;
+	rvec3 tangent2;
+	rvec3 vA;
+	rvec3 vB;
+	real vRel;
+	real depth;
+	int type;
+	bool speculative;
+
+	// contact constraint
+	accum normalImpulseSum;
+	accum tangent1ImpulseSum;
+	accum tangent2ImpulseSum;
+	accum pseudoImpulseSum;
+	rvec3 conjugateDirection;
+	rvec3 impulseSnapshot;
+	real positionImpulseSum;
+	real approachVelocity;
+	real appliedImpulse;
+	bool warm;
+};
+
+struct LinkState
+{
+	real angle;
+	rquat relRotation;
+	rvec3 qd;
+	rvec3 w; // spatial velocity
+	rvec3 v;
+	rvec3 momentum;
+	rvec3 angularMomentum;
+};
+
+class PhysicSnapshot
+{
+
+public:
+	std::vector<BodyState> bodies;
+	std::vector<ManifoldState> manifolds;
+	std::vector<ContactState> contacts;
+	std::vector<real> constraintImpulses; // registry (by type), then the other persistent constraints
+	std::vector<LinkState> links; // all links of all articulations
+	real inactivityTimer = 0;
+
+	void Clear()
+	{
+		bodies.clear();
+		manifolds.clear();
+		contacts.clear();
+		constraintImpulses.clear();
+		links.clear();
+	}
+
+	// compact binary blob: header followed by the arrays
+	void Write(std::vector<char>& blob) const
+	{
+		Header h = header();
+		blob.resize(sizeof(Header) + h.bodies*sizeof(BodyState) + h.manifolds*sizeof(ManifoldState) +
+			h.contacts*sizeof(ContactState) + h.constraintImpulses*sizeof(real) + h.links*sizeof(LinkState));
+
+		char* p = &blob[0];
+		p = write(p, &h, sizeof(Header));
+		p = write(p, bodies.data(), h.bodies*sizeof(BodyState));
+		p = write(p, manifolds.data(), h.manifolds*sizeof(ManifoldState));
+		p = write(p, contacts.data(), h.contacts*sizeof(ContactState));
+		p = write(p, constraintImpulses.data(), h.constraintImpulses*sizeof(real));
+		p = write(p, links.data(), h.links*sizeof(LinkState));
+	}
+
+	// false if the blob is truncated or was written by a build with another scalar type
+	bool Read(const char* data, size_t size)
+	{
+		Header h;
+		if (size < sizeof(Header)) return false;
+		memcpy(&h, data, sizeof(Header));
+
+		if (h.magic != SNAPSHOT_MAGIC || h.version != SNAPSHOT_VERSION) return false;
+		if (h.realSize != sizeof(real) || h.accumSize != sizeof(accum)) return false;
+		if (size != sizeof(Header) + h.bodies*sizeof(BodyState) + h.manifolds*sizeof(ManifoldState) +
+			h.contacts*sizeof(ContactState) + h.constraintImpulses*sizeof(real) + h.links*sizeof(LinkState)) return false;
+
+		// resize keeps the capacity, restoring into a used snapshot does not allocate
+		bodies.resize(h.bodies);
+		manifolds.resize(h.manifolds);
+		contacts.resize(h.contacts);
+		constraintImpulses.resize(h.constraintImpulses);
+		links.resize(h.links);
+		inactivityTimer = h.inactivityTimer;
+
+		const char* p = data + sizeof(Header);
+		p = read(p, bodies.data(), h.bodies*sizeof(BodyState));
+		p = read(p, manifolds.data(), h.manifolds*sizeof(ManifoldState));
+		p = read(p, contacts.data(), h.contacts*sizeof(ContactState));
+		p = read(p, constraintImpulses.data(), h.constraintImpulses*sizeof(real));
+		p = read(p, links.data(), h.links*sizeof(LinkState));
+		return true;
+	}
+
+private:
+
+	struct Header
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t realSize;
+		uint32_t accumSize;
+		uint32_t bodies;
+		uint32_t manifolds;
+		uint32_t contacts;
+		uint32_t constraintImpulses;
+		uint32_t links;
+		real inactivityTimer;
+	};
+
+	Header header() const
+	{
+		Header h;
+		memset(&h, 0, sizeof(Header));
+		h.magic = SNAPSHOT_MAGIC;
+		h.version = SNAPSHOT_VERSION;
+		h.realSize = sizeof(real);
+		h.accumSize = sizeof(accum);
+		h.bodies = bodies.size();
+		h.manifolds = manifolds.size();
+		h.contacts = contacts.size();
+		h.constraintImpulses = constraintImpulses.size();
+		h.links = links.size();
+		h.inactivityTimer = inactivityTimer;
+		return h;
+	}
+
+	static char* write(char* p, const void* data, size_t size)
+	{
+		if (size > 0) memcpy(p, data, size);
+		return p + size;
+	}
+
+	static const char* read(const char* p, void* data, size_t size)
+	{
+		if (size > 0) memcpy(data, p, size);
+		return p + size;
+	}
+};
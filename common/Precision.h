@@ -0,0 +1,42 @@
+/*
+ * Scalar type of the physics core, selected at compile time
+ * default: double, PHYSICS_SINGLE_PRECISION: float (twice the simd width, half the memory bandwidth)
+ * PHYSICS_DOUBLE_ACCUMULATION: with float storage, the solver accumulates the impulses in double
+ */
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#ifdef PHYSICS_SINGLE_PRECISION
+
+typedef float real;
+typedef glm::vec2 rvec2;
+typedef glm::vec3 rvec3;
+typedef glm::vec4 rvec4;
+typedef glm::mat2 rmat2;
+typedef glm::mat3 rmat3;
+typedef glm::mat4 rmat4;
+typedef glm::quat rquat;
+
+#ifdef PHYSICS_DOUBLE_ACCUMULATION
+typedef double accum;
+#else
+typedef float accum;
+#endif
+
+#else
+
+typedef double real;
+typedef glm::dvec2 rvec2;
+typedef glm::dvec3 rvec3;
+typedef glm::dvec4 rvec4;
+typedef glm::dmat2 rmat2;
+typedef glm::dmat3 rmat3;
+typedef glm::dmat4 rmat4;
+typedef glm::dquat rquat;
+
+typedef double accum;
+
+#endif
@@ -0,0 +1,142 @@
+/*
+ * File format of the recorded transform streams (written by ReplayRecorder, read by the replay viewer)
+ *
+ * ReplayFileHeader, then a sequence of records (ReplayRecordHeader + payload):
+ *   ReplayBodies: uint32 count, count*ReplayBodyInfo (whenever the set of bodies changed, before the next frame)
+ *   ReplayFrame:  ReplayFrameHeader, bodyCount transforms (ReplayKeyTransform or ReplayDeltaTransform),
+ *                 contactCount*ReplayContact
+ * All records are 4 byte aligned and self describing (size), s.t. a reader can map the file and skip through
+ * the records to build an index of the frames (seeking starts at the previous keyframe).
+ *
+ * Positions are quantized to multiples of positionQuantum, keyframes store them absolute, the other frames as
+ * 16 bit difference to the quantized position of the previous frame (lossless chain, no drift).
+ * Rotations are stored as smallest three: index of the largest component (2 bits) and the others in 10 bits each.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#define REPLAY_MAGIC 0x50524850 // "PHRP"
+#define REPLAY_VERSION 1
+#define REPLAY_POSITION_QUANTUM (1./1024.) // ~1mm
+#define REPLAY_KEYFRAME_INTERVAL 60
+#define REPLAY_MAX_DELTA 32767
+
+enum ReplayRecordType
+{
+	ReplayBodies = 1,
+	ReplayFrame = 2
+};
+
+enum ReplayFlags
+{
+	ReplayContacts = 1 // the frames contain the contact points
+};
+
+struct ReplayFileHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	float positionQuantum;
+	uint32_t keyframeInterval;
+	uint32_t flags;
+};
+
+struct ReplayRecordHeader
+{
+	uint32_t type;
+	uint32_t size; // of the payload
+};
+
+struct ReplayBodyInfo
+{
+	int32_t id;
+	uint8_t shapeType;
+	uint8_t isStatic;
+	uint16_t reserved;
+	float scale[3];
+};
+
+struct ReplayFrameHeader
+{
+	uint32_t frame;
+	float time;
+	uint32_t bodyCount;
+	uint32_t contactCount;
+	uint32_t keyframe;
+};
+
+struct ReplayKeyTransform
+{
+	int32_t position[3];
+	uint32_t rotation;
+};
+
+struct ReplayDeltaTransform
+{
+	int16_t delta[3];
+	uint16_t reserved;
+	uint32_t rotation;
+};
+
+struct ReplayContact
+{
+	float location[3];
+	float normal[3];
+	float depth;
+};
+
+// smallest three quaternion compression (the largest component is reconstructed from the unit length)
+inline uint32_t ReplayEncodeRotation(const glm::quat& r)
+{
+	float q[4] = { r.x, r.y, r.z, r.w };
+
+	int largest = 0;
+	for (int i=1; i<4; ++i)
+	{
+		if (std::abs(q[i]) > std::abs(q[largest])) largest = i;
+	}
+
+	// q and -q are the same rotation, the largest component is made positive
+	float sign = q[largest] < 0 ? -1.f : 1.f;
+
+	uint32_t bits = largest;
+	for (int i=0; i<4; ++i)
+	{
+		if (i == largest) continue;
+
+		// the others are in [-1/sqrt(2), 1/sqrt(2)]
+		float v = (sign*q[i]*(float)M_SQRT2 + 1.f) * 0.5f;
+		int quantized = (int)std::floor(v*1023.f + 0.5f);
+		quantized = quantized < 0 ? 0 : (quantized > 1023 ? 1023 : quantized);
+		bits = (bits << 10) | (uint32_t)quantized;
+	}
+	return bits;
+}
+
+inline glm::quat ReplayDecodeRotation(uint32_t bits)
+{
+	int largest = bits >> 30;
+
+	float q[4];
+	float sum = 0;
+	int shift = 20;
+	for (int i=0; i<4; ++i)
+	{
+		if (i == largest) continue;
+
+		float v = ((bits >> shift) & 1023) / 1023.f;
+		q[i] = (v*2.f - 1.f) / (float)M_SQRT2;
+		sum += q[i]*q[i];
+		shift -= 10;
+	}
+	q[largest] = std::sqrt(std::max(0.f, 1.f - sum));
+
+	return glm::normalize(glm::quat(q[3], q[0], q[1], q[2]));
+}
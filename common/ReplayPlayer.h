@@ -0,0 +1,228 @@
+/*
+ * Plays a replay file (see ReplayReader.h) in a scene without physics.
+ * The bodies are drawn as instanced models: one master model per shape (and static/dynamic), all the other
+ * bodies with the same shape are instances of it and are rendered in the same draw call.
+ */
+
+#pragma once
+
+#include <glm/glm.hpp>
+using namespace glm;
+
+#include <vector>
+#include <map>
+
+#include "Entity.h"
+#include "Model.h"
+#include "Mesh.h"
+#include "DebugRenderer.h"
+#include "ReplayReader.h"
+
+class ReplayPlayer : public Entity
+{
+
+private:
+	ReplayReader reader;
+
+	int frame = 0;
+	float time = 0;
+	float speed = 1;
+	bool playing = true;
+	bool showFrame = true; // the models have to be updated
+
+	int bodyTable = -1;
+	std::vector<Model*> masters;
+	std::vector<Model*> models; // in the order of the body table
+	std::vector<vec3> positions;
+	std::vector<quat> rotations;
+
+public:
+
+	ReplayPlayer(const char* path) : Entity(vec3(0)), reader(path)
+	{
+		if (reader.GetFrameCount() > 0) time = reader.GetTime(0);
+		std::cout << "replay: " << reader.GetFrameCount() << " frames" << std::endl;
+	}
+
+	virtual ~ReplayPlayer()
+	{
+		clearModels();
+	}
+
+	bool IsOpen() { return reader.IsOpen() && reader.GetFrameCount() > 0; }
+
+	int GetFrame() { return frame; }
+	int GetFrameCount() { return reader.GetFrameCount(); }
+
+	void TogglePlaying() { playing = !playing; }
+	bool IsPlaying() { return playing; }
+
+	void SetSpeed(float speed) { this->speed = speed; }
+	float GetSpeed() { return speed; }
+
+	// shows the frame n (and pauses)
+	void SeekFrame(int n)
+	{
+		if (!IsOpen()) return;
+
+		n = std::max(0, std::min(n, reader.GetFrameCount() - 1));
+		playing = false;
+		frame = n;
+		time = reader.GetTime(n);
+		showFrame = true;
+	}
+
+	void Step(int frames)
+	{
+		SeekFrame(frame + frames);
+	}
+
+	// jumps to the recorded time t (keeps playing)
+	void Seek(float t)
+	{
+		if (!IsOpen()) return;
+
+		frame = reader.FindFrame(t);
+		time = std::max(t, reader.GetTime(0));
+		showFrame = true;
+	}
+
+	void SeekRelative(float dt)
+	{
+		Seek(time + dt);
+	}
+
+	// advances with the recorded time
+	virtual void Update(double dt)
+	{
+		if (!IsOpen()) return;
+
+		if (playing)
+		{
+			time += dt * speed;
+
+			int last = reader.GetFrameCount() - 1;
+			if (time >= reader.GetTime(last))
+			{
+				time = reader.GetTime(last);
+				playing = false;
+			}
+
+			int next = reader.FindFrame(time);
+			if (next != frame)
+			{
+				frame = next;
+				showFrame = true;
+			}
+		}
+
+		if (showFrame)
+		{
+			updateModels();
+			showFrame = false;
+		}
+
+		addContacts();
+	}
+
+	virtual void Draw(Shader& shader)
+	{
+		for (Model* m : masters)
+		{
+			m->Draw(shader);
+		}
+	}
+
+private:
+
+	// the recorded contacts of the frame are shown as debug points (the debug renderer draws them once, so they
+	// are added every update and not in every render pass)
+	void addContacts()
+	{
+		DebugRenderer* debug = DebugRenderer::Instance();
+		if (!debug->IsEnabled() || !reader.HasContacts()) return;
+
+		int count;
+		const ReplayContact* c = reader.GetContacts(frame, count);
+		for (int i=0; i<count; ++i)
+		{
+			debug->AddDebugPoint(vec3(c[i].location[0], c[i].location[1], c[i].location[2]), vec3(1,0,0), 5);
+		}
+	}
+
+	void updateModels()
+	{
+		if (reader.GetBodyTable(frame) != bodyTable) createModels();
+
+		reader.ReadFrame(frame, positions, rotations);
+
+		int n = models.size();
+		for (int i=0; i<n; ++i)
+		{
+			models[i]->SetPosition(positions[i]);
+			models[i]->SetRotation(rotations[i]);
+		}
+	}
+
+	// the first body with a shape creates the master model, all the others are instances of it
+	void createModels()
+	{
+		clearModels();
+		bodyTable = reader.GetBodyTable(frame);
+
+		std::map<std::pair<int,int>, Model*> masterOf;
+		const ReplayBodyInfo* bodies = reader.GetBodies(frame);
+		int n = reader.GetBodyCount(frame);
+		for (int i=0; i<n; ++i)
+		{
+			const ReplayBodyInfo& b = bodies[i];
+			std::pair<int,int> key(b.shapeType, b.isStatic);
+
+			Model* model;
+			std::map<std::pair<int,int>, Model*>::iterator master = masterOf.find(key);
+			if (master == masterOf.end())
+			{
+				model = new Model(createMesh((ShapeType)b.shapeType, b.isStatic), vec3(0));
+				masterOf[key] = model;
+				masters.push_back(model);
+			}
+			else
+			{
+				model = master->second->CreateInstance(vec3(0));
+			}
+
+			model->SetScale(vec3(b.scale[0], b.scale[1], b.scale[2]));
+			model->SetStaticGeometry(b.isStatic);
+			models.push_back(model);
+		}
+	}
+
+	void clearModels()
+	{
+		// the masters are part of the models (and own the meshes)
+		for (Model* m : models)
+		{
+			delete m;
+		}
+		models.clear();
+		masters.clear();
+		bodyTable = -1;
+	}
+
+	static Mesh* createMesh(ShapeType type, bool isStatic)
+	{
+		vec3 color = isStatic ? vec3(0.6) : vec3(1,1,0);
+
+		switch (type)
+		{
+			case ShapeType::Point:		return MeshGenerator::CreatePoint(color);
+			case ShapeType::Triangle:	return MeshGenerator::CreateTriangle(color);
+			case ShapeType::Plane:		return MeshGenerator::CreatePlane(color);
+			case ShapeType::Pyramid:	return MeshGenerator::CreatePyramid(color);
+			case ShapeType::Cylinder:	return MeshGenerator::CreateCylinder(color);
+			case ShapeType::Sphere:		return MeshGenerator::CreateSphere(color);
+			case ShapeType::Lane:		return MeshGenerator::CreateLane(color);
+			default:					return MeshGenerator::CreateBox(color); // general meshes are not recorded
+		}
+	}
+};
@@ -0,0 +1,260 @@
+/*
+ * Reads a replay file written by ReplayRecorder (format: see ReplayFormat.h)
+ * The file is memory mapped, opening only skips through the records to build the index of the frames.
+ * A frame is decoded from its keyframe on, stepping forward from the last decoded frame only applies one delta.
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstring>
+#include <cstddef>
+#include <iostream>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "ReplayFormat.h"
+
+class ReplayReader
+{
+
+private:
+	struct FrameEntry
+	{
+		const char* data; // frame header
+		int keyframe; // index of the keyframe the frame is decoded from
+		int bodyTable;
+	};
+
+	struct BodyTable
+	{
+		const ReplayBodyInfo* bodies;
+		int count;
+	};
+
+	int fd = -1;
+	const char* data = NULL;
+	size_t size = 0;
+	ReplayFileHeader header;
+
+	std::vector<FrameEntry> frames;
+	std::vector<BodyTable> bodyTables;
+
+	// quantized positions of the last decoded frame
+	int decodedFrame = -1;
+	std::vector<int32_t> positions;
+
+public:
+
+	ReplayReader(const char* path)
+	{
+		fd = open(path, O_RDONLY);
+		if (fd < 0)
+		{
+			std::cout << "could not open replay file " << path << std::endl;
+			return;
+		}
+
+		struct stat st;
+		if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(ReplayFileHeader))
+		{
+			std::cout << "invalid replay file " << path << std::endl;
+			Close();
+			return;
+		}
+		size = st.st_size;
+
+		void* p = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (p == MAP_FAILED)
+		{
+			std::cout << "could not map replay file " << path << std::endl;
+			size = 0;
+			Close();
+			return;
+		}
+		data = (const char*)p;
+
+		memcpy(&header, data, sizeof(ReplayFileHeader));
+		if (header.magic != REPLAY_MAGIC || header.version != REPLAY_VERSION)
+		{
+			std::cout << "invalid replay file " << path << std::endl;
+			Close();
+			return;
+		}
+
+		buildIndex();
+	}
+
+	~ReplayReader()
+	{
+		Close();
+	}
+
+	void Close()
+	{
+		if (data != NULL) munmap((void*)data, size);
+		if (fd >= 0) close(fd);
+		data = NULL;
+		size = 0;
+		fd = -1;
+		frames.clear();
+		bodyTables.clear();
+		decodedFrame = -1;
+	}
+
+	bool IsOpen() { return data != NULL; }
+	bool HasContacts() { return IsOpen() && (header.flags & ReplayContacts) != 0; }
+
+	int GetFrameCount() { return frames.size(); }
+
+	float GetTime(int frame) { return getFrameHeader(frame).time; }
+
+	// the frames with the same body table show the same bodies in the same order
+	int GetBodyTable(int frame) { return frames[frame].bodyTable; }
+
+	int GetBodyCount(int frame) { return bodyTables[frames[frame].bodyTable].count; }
+
+	const ReplayBodyInfo* GetBodies(int frame) { return bodyTables[frames[frame].bodyTable].bodies; }
+
+	// last frame with a time <= t
+	int FindFrame(float t)
+	{
+		int lo = 0;
+		int hi = (int)frames.size() - 1;
+		if (hi < 0 || t <= GetTime(0)) return 0;
+
+		while (lo < hi)
+		{
+			int mid = (lo + hi + 1) / 2;
+			if (GetTime(mid) <= t) lo = mid;
+			else hi = mid - 1;
+		}
+		return lo;
+	}
+
+	// decodes the transforms of the bodies of the frame (in the order of its body table)
+	void ReadFrame(int frame, std::vector<glm::vec3>& position, std::vector<glm::quat>& rotation)
+	{
+		int start = frames[frame].keyframe;
+		if (decodedFrame >= start && decodedFrame <= frame) start = decodedFrame + 1;
+
+		for (int i=start; i<=frame; ++i)
+		{
+			applyPositions(i);
+		}
+		decodedFrame = frame;
+
+		const ReplayFrameHeader& h = getFrameHeader(frame);
+		position.resize(h.bodyCount);
+		rotation.resize(h.bodyCount);
+
+		const char* p = frames[frame].data + sizeof(ReplayFrameHeader);
+		size_t stride = h.keyframe ? sizeof(ReplayKeyTransform) : sizeof(ReplayDeltaTransform);
+		size_t rotationOffset = h.keyframe ? offsetof(ReplayKeyTransform, rotation) : offsetof(ReplayDeltaTransform, rotation);
+		for (uint32_t i=0; i<h.bodyCount; ++i)
+		{
+			uint32_t r;
+			memcpy(&r, p + i*stride + rotationOffset, sizeof(uint32_t));
+			rotation[i] = ReplayDecodeRotation(r);
+			position[i] = glm::vec3(positions[3*i], positions[3*i+1], positions[3*i+2]) * header.positionQuantum;
+		}
+	}
+
+	// contact points of the frame (only if recorded with contacts)
+	const ReplayContact* GetContacts(int frame, int& count)
+	{
+		const ReplayFrameHeader& h = getFrameHeader(frame);
+		count = h.contactCount;
+		size_t stride = h.keyframe ? sizeof(ReplayKeyTransform) : sizeof(ReplayDeltaTransform);
+		return (const ReplayContact*)(frames[frame].data + sizeof(ReplayFrameHeader) + h.bodyCount*stride);
+	}
+
+private:
+
+	const ReplayFrameHeader& getFrameHeader(int frame)
+	{
+		return *(const ReplayFrameHeader*)frames[frame].data;
+	}
+
+	// a truncated or inconsistent record ends the index (recording not closed or corrupt file), all records before
+	// it are complete
+	void buildIndex()
+	{
+		size_t offset = sizeof(ReplayFileHeader);
+		int keyframe = -1;
+		int keyframeTable = -1; // body table of the keyframe
+
+		while (offset + sizeof(ReplayRecordHeader) <= size)
+		{
+			ReplayRecordHeader r;
+			memcpy(&r, data + offset, sizeof(ReplayRecordHeader));
+			const char* payload = data + offset + sizeof(ReplayRecordHeader);
+			offset += sizeof(ReplayRecordHeader) + r.size;
+			if (offset > size) break;
+
+			if (r.type == ReplayBodies)
+			{
+				if (r.size < sizeof(uint32_t)) break;
+
+				BodyTable table;
+				table.count = *(const uint32_t*)payload;
+				table.bodies = (const ReplayBodyInfo*)(payload + sizeof(uint32_t));
+				if (table.count < 0 || r.size < sizeof(uint32_t) + (size_t)table.count*sizeof(ReplayBodyInfo)) break;
+
+				bodyTables.push_back(table);
+			}
+			else if (r.type == ReplayFrame && !bodyTables.empty())
+			{
+				if (r.size < sizeof(ReplayFrameHeader)) break;
+
+				const ReplayFrameHeader* h = (const ReplayFrameHeader*)payload;
+				size_t stride = h->keyframe ? sizeof(ReplayKeyTransform) : sizeof(ReplayDeltaTransform);
+				if (r.size < sizeof(ReplayFrameHeader) + (size_t)h->bodyCount*stride + (size_t)h->contactCount*sizeof(ReplayContact)) break;
+				if (h->bodyCount != (uint32_t)bodyTables.back().count) break;
+
+				if (h->keyframe)
+				{
+					keyframe = frames.size();
+					keyframeTable = bodyTables.size() - 1;
+				}
+				if (keyframe < 0) continue;
+
+				// the deltas apply to the positions of the same bodies
+				if (keyframeTable != (int)bodyTables.size() - 1) break;
+
+				FrameEntry e;
+				e.data = payload;
+				e.keyframe = keyframe;
+				e.bodyTable = bodyTables.size() - 1;
+				frames.push_back(e);
+			}
+		}
+	}
+
+	void applyPositions(int frame)
+	{
+		const ReplayFrameHeader& h = getFrameHeader(frame);
+		const char* p = frames[frame].data + sizeof(ReplayFrameHeader);
+
+		if (h.keyframe)
+		{
+			positions.resize(3*h.bodyCount);
+			const ReplayKeyTransform* t = (const ReplayKeyTransform*)p;
+			for (uint32_t i=0; i<h.bodyCount; ++i)
+			{
+				for (int k=0; k<3; ++k) positions[3*i+k] = t[i].position[k];
+			}
+		}
+		else
+		{
+			const ReplayDeltaTransform* t = (const ReplayDeltaTransform*)p;
+			for (uint32_t i=0; i<h.bodyCount; ++i)
+			{
+				for (int k=0; k<3; ++k) positions[3*i+k] += t[i].delta[k];
+			}
+		}
+	}
+};
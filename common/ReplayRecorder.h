@@ -0,0 +1,287 @@
+/*
+ * Records the transforms of all bodies (and optionally the contacts) of every step into a replay file
+ * (format: see ReplayFormat.h)
+ * The frames are encoded in the step thread (quantization only) and written by a background thread,
+ * the step loop never waits for the disk.
+ */
+
+#pragma once
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <iostream>
+
+#include "RigidBody.h"
+#include "ReplayFormat.h"
+
+class ReplayRecorder
+{
+
+private:
+	FILE* file = NULL;
+	bool recordContacts;
+	real positionQuantum;
+	int keyframeInterval;
+
+	uint32_t frame = 0;
+	double time = 0;
+	std::vector<int> ids; // bodies of the last body table
+	std::vector<int32_t> previous; // quantized positions of the last frame
+	std::vector<int32_t> current;
+
+	// encoded frames waiting for the writer, the buffers are reused
+	std::thread writer;
+	std::mutex mutex;
+	std::condition_variable condition;
+	std::deque<std::vector<char>*> queue;
+	std::vector<std::vector<char>*> freeBuffers;
+	bool stop = false;
+
+public:
+
+	ReplayRecorder(const char* path, bool recordContacts = false, real positionQuantum = REPLAY_POSITION_QUANTUM, int keyframeInterval = REPLAY_KEYFRAME_INTERVAL)
+	{
+		this->recordContacts = recordContacts;
+		this->positionQuantum = positionQuantum;
+		this->keyframeInterval = std::max(keyframeInterval, 1);
+
+		file = fopen(path, "wb");
+		if (file == NULL)
+		{
+			std::cout << "could not open replay file " << path << std::endl;
+			return;
+		}
+
+		ReplayFileHeader h;
+		h.magic = REPLAY_MAGIC;
+		h.version = REPLAY_VERSION;
+		h.positionQuantum = positionQuantum;
+		h.keyframeInterval = this->keyframeInterval;
+		h.flags = recordContacts ? ReplayContacts : 0;
+		fwrite(&h, sizeof(ReplayFileHeader), 1, file);
+
+		writer = std::thread(&ReplayRecorder::writeLoop, this);
+	}
+
+	~ReplayRecorder()
+	{
+		Close();
+	}
+
+	bool IsOpen() { return file != NULL; }
+	int GetFrameCount() { return frame; }
+
+	// the bodies were replaced (the ids start again at 0), the next frame writes a new body table
+	void ResetBodyTable()
+	{
+		ids.clear();
+	}
+
+	// writes the remaining frames and closes the file
+	void Close()
+	{
+		if (file == NULL) return;
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stop = true;
+		}
+		condition.notify_one();
+		writer.join();
+
+		fclose(file);
+		file = NULL;
+
+		for (std::vector<char>* b : freeBuffers)
+		{
+			delete b;
+		}
+		freeBuffers.clear();
+	}
+
+	// encodes the current state of the bodies as the next frame, dt: simulated time since the last frame
+	void Record(std::vector<RigidBody*>& bodies, std::unordered_map<std::pair<int,int>, ContactManifold*>& manifolds, real dt)
+	{
+		if (file == NULL) return;
+
+		std::vector<char>* buffer = getBuffer();
+		time += dt;
+
+		int n = bodies.size();
+		bool bodiesChanged = (int)ids.size() != n;
+		for (int i=0; i<n && !bodiesChanged; ++i)
+		{
+			bodiesChanged = ids[i] != bodies[i]->GetId();
+		}
+		if (bodiesChanged) writeBodyTable(*buffer, bodies);
+
+		// quantize, the deltas must fit into 16 bits
+		bool keyframe = bodiesChanged || frame % keyframeInterval == 0;
+		current.resize(3*n);
+		for (int i=0; i<n; ++i)
+		{
+			rvec3 p = bodies[i]->GetPosition();
+			for (int k=0; k<3; ++k)
+			{
+				current[3*i+k] = (int32_t)std::floor(p[k] / positionQuantum + 0.5);
+				if (!keyframe && std::abs(current[3*i+k] - previous[3*i+k]) > REPLAY_MAX_DELTA) keyframe = true;
+			}
+		}
+
+		size_t start = beginRecord(*buffer, ReplayFrame);
+		size_t frameHeader = buffer->size();
+
+		ReplayFrameHeader h;
+		h.frame = frame++;
+		h.time = (float)time;
+		h.bodyCount = n;
+		h.contactCount = 0;
+		h.keyframe = keyframe;
+		append(*buffer, &h, sizeof(ReplayFrameHeader));
+
+		for (int i=0; i<n; ++i)
+		{
+			rquat r = bodies[i]->GetRotation();
+			uint32_t rotation = ReplayEncodeRotation(glm::quat((float)r.w, (float)r.x, (float)r.y, (float)r.z));
+
+			if (keyframe)
+			{
+				ReplayKeyTransform t;
+				for (int k=0; k<3; ++k) t.position[k] = current[3*i+k];
+				t.rotation = rotation;
+				append(*buffer, &t, sizeof(ReplayKeyTransform));
+			}
+			else
+			{
+				ReplayDeltaTransform t;
+				for (int k=0; k<3; ++k) t.delta[k] = (int16_t)(current[3*i+k] - previous[3*i+k]);
+				t.reserved = 0;
+				t.rotation = rotation;
+				append(*buffer, &t, sizeof(ReplayDeltaTransform));
+			}
+		}
+
+		if (recordContacts)
+		{
+			for (std::pair<const std::pair<int,int>, ContactManifold*>& i : manifolds)
+			{
+				for (Contact* c : i.second->contacts)
+				{
+					ReplayContact rc;
+					for (int k=0; k<3; ++k)
+					{
+						rc.location[k] = c->location[k];
+						rc.normal[k] = c->normal[k];
+					}
+					rc.depth = c->depth;
+					append(*buffer, &rc, sizeof(ReplayContact));
+					h.contactCount++;
+				}
+			}
+			memcpy(&(*buffer)[frameHeader], &h, sizeof(ReplayFrameHeader));
+		}
+
+		endRecord(*buffer, start);
+		current.swap(previous);
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			queue.push_back(buffer);
+		}
+		condition.notify_one();
+	}
+
+private:
+
+	void writeBodyTable(std::vector<char>& buffer, std::vector<RigidBody*>& bodies)
+	{
+		size_t start = beginRecord(buffer, ReplayBodies);
+
+		uint32_t count = bodies.size();
+		append(buffer, &count, sizeof(uint32_t));
+
+		ids.resize(count);
+		for (uint32_t i=0; i<count; ++i)
+		{
+			RigidBody* b = bodies[i];
+			ids[i] = b->GetId();
+
+			ReplayBodyInfo info;
+			info.id = b->GetId();
+			info.shapeType = b->GetShape()->GetShapeType();
+			info.isStatic = b->IsStatic();
+			info.reserved = 0;
+			for (int k=0; k<3; ++k) info.scale[k] = b->GetScale()[k];
+			append(buffer, &info, sizeof(ReplayBodyInfo));
+		}
+
+		endRecord(buffer, start);
+	}
+
+	size_t beginRecord(std::vector<char>& buffer, ReplayRecordType type)
+	{
+		size_t start = buffer.size();
+		ReplayRecordHeader h = { (uint32_t)type, 0 };
+		append(buffer, &h, sizeof(ReplayRecordHeader));
+		return start;
+	}
+
+	void endRecord(std::vector<char>& buffer, size_t start)
+	{
+		// pad to 4 bytes
+		while (buffer.size() % 4 != 0) buffer.push_back(0);
+
+		ReplayRecordHeader h = { 0, (uint32_t)(buffer.size() - start - sizeof(ReplayRecordHeader)) };
+		memcpy(&h.type, &buffer[start], sizeof(uint32_t));
+		memcpy(&buffer[start], &h, sizeof(ReplayRecordHeader));
+	}
+
+	static void append(std::vector<char>& buffer, const void* data, size_t size)
+	{
+		const char* bytes = (const char*)data;
+		buffer.insert(buffer.end(), bytes, bytes + size);
+	}
+
+	std::vector<char>* getBuffer()
+	{
+		std::vector<char>* buffer = NULL;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (!freeBuffers.empty())
+			{
+				buffer = freeBuffers.back();
+				freeBuffers.pop_back();
+			}
+		}
+		if (buffer == NULL) buffer = new std::vector<char>();
+
+		buffer->clear();
+		return buffer;
+	}
+
+	void writeLoop()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		while (true)
+		{
+			condition.wait(lock, [this]{ return stop || !queue.empty(); });
+			if (queue.empty()) break; // stopped and everything written
+
+			std::vector<char>* buffer = queue.front();
+			queue.pop_front();
+
+			lock.unlock();
+			fwrite(buffer->data(), 1, buffer->size(), file);
+			lock.lock();
+
+			freeBuffers.push_back(buffer);
+		}
+		fflush(file);
+	}
+};
@@ -19,7 +19,9 @@ using namespace glm;
 #include "Shape.h"
 #include "timer.h"
 #include "limits.h"
+#include "Precision.h"
 #include "AABB.h"
+#include "PhysicSnapshot.h"
 #include "collision/Contact.h"
 #include "collision/GJKSimplex.h"
 #include "collision/EPAPolytope.h"
@@ -40,7 +42,9 @@ class RigidBody
 	friend class NaiveCollisionDetector; 
 	friend class SpatialPartitioningCollisionDetector; 
 	friend class InactivityDetector; 
+	friend class Constraint;
 	friend class ContactConstraint; 
+	friend class ContactManifoldConstraint;
 	friend class DistanceConstraint; 
 	friend class BodyDistanceConstraint; 
 	friend class TwoBodyDistanceConstraint;
@@ -49,54 +53,71 @@ class RigidBody
 	friend class BallJointConstraint;
 	friend class SoftDistanceConstraint;
 	friend class SpringConstraint;
+	friend class Articulation;
 
 private:
 		static int idCounter;
 		int id; // gives rigidBodies an order
 
 		bool isDirty = true; // model matrix M is not up to date
-		dmat4 M;
+		rmat4 M;
 
 		// shape
 		Shape* shape;			
 		AABB aabb;
 
 		// constants
-		double inverseMass;
-		dmat3 inertiaTensorBodyInverse;
-		dvec3 scale; 
+		real inverseMass;
+		rmat3 inertiaTensorBodyInverse;
+		rvec3 scale; 
 
 		// state
-		dvec3 position; 
-		dquat rotation;
-		dvec3 linearMomentum;  // Impuls		
-		dvec3 angularMomentum; // Drehimpuls (L)
-		dmat3 inertiaTensorInverse;
+		rvec3 position; 
+		rquat rotation;
+		rvec3 linearMomentum;  // Impuls		
+		rvec3 angularMomentum; // Drehimpuls (L)
+		rmat3 inertiaTensorInverse;
 
 		// rate of change
-		dvec3 velocity; 
-		dvec3 angularVelocity;  // omega
-		dvec3 force;  // Kraft
-		dvec3 torque; // Drehmoment (M)
+		rvec3 velocity; 
+		rvec3 angularVelocity;  // omega
+		rvec3 force;  // Kraft
+		rvec3 torque; // Drehmoment (M)
+
+		// split impulse: velocities only used to integrate the position in the next step (not fed back into momentum)
+		rvec3 pseudoVelocity;
+		rvec3 pseudoAngularVelocity;
+
+		// position based dynamics: pose at the beginning of the substep, the velocities are derived from the change
+		rvec3 previousPosition;
+		rquat previousRotation;
 		
 		// static flag for physics
 		bool isStatic = false;
 
-		double friction = 0.5; // between 0 and 1 (1 means highest friction; will be mutiplied with friction of other body during contact)
-		double restitution = 0.7; // betwee 0 and 1 (multiplied with restitution of other body during contact)
+		real friction = 0.5; // between 0 and 1 (1 means highest friction; will be mutiplied with friction of other body during contact)
+		real restitution = 0.7; // betwee 0 and 1 (multiplied with restitution of other body during contact)
 
 		// sleeping
 		bool enableSleeping = true;
 		bool sleeping = false;
-		double changeAverageN = 10./120.;
-		double sleepThreshold = 0.1;
-		double changeAverage = 1000; // dont enable sleeping for the first cycles
+		real changeAverageN = 10./120.;
+		real sleepThreshold = 0.1;
+		real changeAverage = 1000; // dont enable sleeping for the first cycles
 
 		bool inactive = false;
 		int inactiveSetId;
 		bool forceWakeup = false;
 		bool grounded = false;
 
+		int islandNode = -1; // scratch index of the constraint solver island search
+		int stackLevel = -1; // shock propagation: number of contacts to the static ground (0: static, -1: not connected)
+
+		bool articulated = false; // part of an articulation, integrated in joint coordinates
+
+		// bodies closer than the sum of their margins get speculative contacts (0 = disabled)
+		real speculativeMargin = 0;
+
 		std::unordered_map<int, ContactManifold*> manifolds;
 
 	public:
@@ -111,6 +132,59 @@ private:
 			}
 		}
 
+		// simulation state for the snapshots of the physic manager (the constants and the shape are not included)
+		void SaveState(BodyState& s) const
+		{
+			s.id = id;
+			s.position = position;
+			s.rotation = rotation;
+			s.linearMomentum = linearMomentum;
+			s.angularMomentum = angularMomentum;
+			s.inertiaTensorInverse = inertiaTensorInverse;
+			s.velocity = velocity;
+			s.angularVelocity = angularVelocity;
+			s.force = force;
+			s.torque = torque;
+			s.pseudoVelocity = pseudoVelocity;
+			s.pseudoAngularVelocity = pseudoAngularVelocity;
+			s.previousPosition = previousPosition;
+			s.previousRotation = previousRotation;
+			s.changeAverage = changeAverage;
+			s.speculativeMargin = speculativeMargin;
+			s.inactiveSetId = inactiveSetId;
+			s.sleeping = sleeping;
+			s.inactive = inactive;
+			s.forceWakeup = forceWakeup;
+			s.grounded = grounded;
+		}
+
+		void RestoreState(const BodyState& s)
+		{
+			position = s.position;
+			rotation = s.rotation;
+			linearMomentum = s.linearMomentum;
+			angularMomentum = s.angularMomentum;
+			inertiaTensorInverse = s.inertiaTensorInverse;
+			velocity = s.velocity;
+			angularVelocity = s.angularVelocity;
+			force = s.force;
+			torque = s.torque;
+			pseudoVelocity = s.pseudoVelocity;
+			pseudoAngularVelocity = s.pseudoAngularVelocity;
+			previousPosition = s.previousPosition;
+			previousRotation = s.previousRotation;
+			changeAverage = s.changeAverage;
+			speculativeMargin = s.speculativeMargin;
+			inactiveSetId = s.inactiveSetId;
+			sleeping = s.sleeping;
+			inactive = s.inactive;
+			forceWakeup = s.forceWakeup;
+			grounded = s.grounded;
+
+			isDirty = true;
+			UpdateAABB();
+		}
+
 		void PrintForce(){
 			std::cout << "  force on body with id " << id << ": (" << force[0] << "," << force[1] << "," << force[2] << ")  isStatic = " << isStatic << "\n";
 			//~ std::cout << "  torque on body with id " << id << ": (" << torque[0] << "," << torque[1] << "," << torque[2] << ")  isStatic = " << isStatic << "\n";
@@ -123,27 +197,29 @@ private:
 		}
 	
 	
-		RigidBody(dvec3 pos, Shape* shape)
+		RigidBody(rvec3 pos, Shape* shape)
 		{
 			assert(shape != NULL);
 
 			this->position = pos;
 			this->shape = shape;
 			
-			this->rotation = dquat(dvec3(0,0,0));
-			this->velocity = dvec3(0,0,0);
-			this->linearMomentum = dvec3(0,0,0);
-			this->angularMomentum = dvec3(0,0,0);
+			this->rotation = rquat(rvec3(0,0,0));
+			this->velocity = rvec3(0,0,0);
+			this->linearMomentum = rvec3(0,0,0);
+			this->angularMomentum = rvec3(0,0,0);
 
-			this->angularVelocity = dvec3(0,0,0);
-			this->force = dvec3(0,0,0);
-			this->torque = dvec3(0,0,0);
+			this->angularVelocity = rvec3(0,0,0);
+			this->force = rvec3(0,0,0);
+			this->torque = rvec3(0,0,0);
+			this->pseudoVelocity = rvec3(0,0,0);
+			this->pseudoAngularVelocity = rvec3(0,0,0);
 
 			// derived 
-			double mass = 1.0f;
+			real mass = 1.0f;
 			this->inverseMass = 1. / mass;
 
-			dmat3 inertiaTensorBody = dmat3(1);
+			rmat3 inertiaTensorBody = rmat3(1);
 			this->inertiaTensorBodyInverse = inverse(inertiaTensorBody);
 			this->inertiaTensorInverse = inertiaTensorBodyInverse;
 			
@@ -161,29 +237,33 @@ private:
 		}
 
 		static void ResetCounter() { idCounter = 0; }
-		void SetAngularVelocity(const dvec3 vel) { this->angularVelocity = vel; }
-		void SetInertiaTensorBody(const dmat3 t) { this->inertiaTensorBodyInverse = inverse(t); }
-		void SetInertiaTensorBodyInverse(const dmat3 t) { this->inertiaTensorBodyInverse = t; }
-		const dmat3 GetInertiaTensorInverse() { return this->inertiaTensorInverse; }
+		void SetAngularVelocity(const rvec3 vel) { this->angularVelocity = vel; }
+		const rvec3 GetAngularVelocity() { return this->angularVelocity; }
+		const rvec3 GetVelocity() { return this->velocity; }
+		void SetInertiaTensorBody(const rmat3 t) { this->inertiaTensorBodyInverse = inverse(t); }
+		void SetInertiaTensorBodyInverse(const rmat3 t) { this->inertiaTensorBodyInverse = t; }
+		const rmat3 GetInertiaTensorInverse() { return this->inertiaTensorInverse; }
+
+		real GetInverseMass() { return this->inverseMass; }
+		void SetInverseMass(real mass) { this->inverseMass = mass; }
+		void SetMass(real mass) { assert(mass != 0); this->inverseMass = 1./mass; }
 
-		double GetInverseMass() { return this->inverseMass; }
-		void SetInverseMass(double mass) { this->inverseMass = mass; }
-		void SetMass(double mass) { assert(mass != 0); this->inverseMass = 1./mass; }
+		void SetFriction(const real friction) { this->friction = friction; }
+		const real GetFriction() { return this->friction; }
 
-		void SetFriction(const double friction) { this->friction = friction; }
-		const double GetFriction() { return this->friction; }
+		void SetRestitution(const real restitution) { this->restitution = restitution; }
+		const real GetRestitution() { return this->restitution; }
 
-		void SetRestitution(const double restitution) { this->restitution = restitution; }
-		const double GetRestitution() { return this->restitution; }
+		void SetScale(const rvec3 scale) { isDirty = true; this->scale = scale; UpdateAABB(); UpdateInertiaTensorBody(); }
+		const rvec3 GetScale() { return this->scale; }
 
-		void SetScale(const dvec3 scale) { isDirty = true; this->scale = scale; UpdateAABB(); UpdateInertiaTensorBody(); }
-		const dvec3 GetScale() { return this->scale; }
+		void SetPosition(const rvec3 pos) { isDirty = true; this->position = pos; UpdateAABB(); }
+		const rvec3 GetPosition() { return this->position; }
 
-		void SetPosition(const dvec3 pos) { isDirty = true; this->position = pos; UpdateAABB(); }
-		const dvec3 GetPosition() { return this->position; }
+		void SetRotation(const rquat r) { isDirty = true; this->rotation = r; UpdateAABB(); }
+		const rquat GetRotation() { return this->rotation; }
 
-		void SetRotation(const dquat r) { isDirty = true; this->rotation = r; UpdateAABB(); }
-		const dquat GetRotation() { return this->rotation; }
+		Shape* GetShape() { return this->shape; }
 
 		void SetSleepingEnabled(bool en) { this->enableSleeping = en; }
 
@@ -202,8 +282,8 @@ private:
 			this->inverseMass = 0;
 			this->isStatic = true;
 			this->sleeping = true;
-			this->inertiaTensorInverse = dmat3(0);
-			this->inertiaTensorBodyInverse = dmat3(0);
+			this->inertiaTensorInverse = rmat3(0);
+			this->inertiaTensorBodyInverse = rmat3(0);
 			UpdateAABB(); // we calculate the aabb only once !
 		}
 		
@@ -212,114 +292,131 @@ private:
 			return this->isStatic;
 		}
 
+		// put to sleep by the inactivity detector (not integrated)
+		bool IsInactive()
+		{
+			return this->inactive;
+		}
+
 
 		// simple euler integration
-		void IntegrationStep(double dt)
+		void IntegrationStep(real dt)
 		{
 			if (isStatic) return;
 			if (inactive) return;
+			if (articulated) return;
 	
-			if (enableSleeping && !forceWakeup)
-			{
-				if (changeAverage < sleepThreshold && length(linearMomentum) < sleepThreshold && length(angularMomentum) < sleepThreshold)
-				{
-					sleeping = true;
-
-					// artificial damping increases stability
-					linearMomentum *= 0.7;
-					angularMomentum *= 0.4;
-				}
-				else if (sleeping)
-				{
-					sleeping = false;
-				}
-			}
+			updateSleeping();
 			
 			if (!sleeping || forceWakeup)
 			{
-
-				// integrate position
-				position += dt*velocity;
-
-				rotation += dquat(0, 0.5*dt*angularVelocity.x, 0.5*dt*angularVelocity.y, 0.5*dt*angularVelocity.z) * rotation;
-				rotation = normalize(rotation);
-				dmat3 R = glm::mat3_cast(rotation);
-				inertiaTensorInverse = R * inertiaTensorBodyInverse * transpose(R);
-				isDirty = true;
-
-				// integrate velocity
-				angularMomentum += dt* torque;
-				linearMomentum += dt*force;
-				velocity = linearMomentum * inverseMass;
-				angularVelocity = inertiaTensorInverse * angularMomentum;
+				integratePosition(dt);
+				integrateVelocity(dt);
 
 				// update bounding box
 				UpdateAABB();
 			}
 
-
-			// update sleep params
-			changeAverage = (changeAverageN/dt * changeAverage + length(velocity) + length(angularVelocity)) / (changeAverageN/dt + 1);
-			forceWakeup = false;
+			updateSleepParams(dt);
+			clearPseudoVelocity();
 		}
 
 		// integration step 1st part, integrate velocities
-		void IntegrationStepVelocities(double dt)
+		// (used by the temporal gauss seidel stepping, which solves the constraints between the two parts)
+		void IntegrationStepVelocities(real dt)
 		{
 			if (isStatic) return;
-	
-			/// TODO: is this needed in velocities intgrator???
-			if (enableSleeping && changeAverage < sleepThreshold && length(linearMomentum) < sleepThreshold && length(angularMomentum) < sleepThreshold)
+			if (inactive) return;
+			if (articulated) return;
+
+			updateSleeping();
+
+			if (!sleeping || forceWakeup)
 			{
-				linearMomentum *= 0.7;
-				angularMomentum *= 0.4;
-				return;
+				integrateVelocity(dt);
 			}
-			
-
-			changeAverage = (changeAverageN * changeAverage + length(velocity) + length(angularVelocity)) / (changeAverageN + 1);
+		}
 
-			linearMomentum += dt*force;
+		// integration step 2nd part, integrate positions
+		void IntegrationStepPositions(real dt)
+		{
+			if (isStatic) return;
+			if (inactive) return;
+			if (articulated) return;
 
-			angularMomentum += dt* torque;
+			if (!sleeping || forceWakeup)
+			{
+				integratePosition(dt);
+				UpdateAABB();
+			}
 
-			velocity = linearMomentum * inverseMass;
-			angularVelocity = inertiaTensorInverse * angularMomentum;
+			updateSleepParams(dt);
+			clearPseudoVelocity();
 		}
 
-		// integration step 2nd part, integrate positions
-		void IntegrationStepPositions(double dt)
+		// position based dynamics (XPBD) substep, 1st part: save the pose and predict it by integrating velocity and position
+		// the constraints are then projected on position level, see UpdateVelocitiesXPBD for the 2nd part
+		void IntegrationStepXPBD(real dt)
 		{
-			isDirty = true;
+			previousPosition = position;
+			previousRotation = rotation;
 
 			if (isStatic) return;
-	
-			/// TODO: is this needed in velocities intgrator???
-			if (enableSleeping)
+			if (inactive) return;
+			if (articulated) return;
+
+			updateSleeping();
+
+			if (!sleeping || forceWakeup)
 			{
-				if (changeAverage < sleepThreshold && length(linearMomentum) < sleepThreshold && length(angularMomentum) < sleepThreshold)
-				{
-					sleeping = true;
-					return;
-				}
-				else if (sleeping)
-				{
-					sleeping = false;
-				}
+				integrateVelocity(dt);
+				integratePosition(dt);
+				UpdateAABB();
 			}
-			changeAverage = (changeAverageN * changeAverage + length(velocity) + length(angularVelocity)) / (changeAverageN + 1);
+		}
 
-			position += dt*velocity;
+		// position based dynamics substep, 2nd part: velocities from the change of the pose
+		// reference: https://matthias-research.github.io/pages/publications/PBDBodies.pdf (algorithm 2)
+		void UpdateVelocitiesXPBD(real dt)
+		{
+			if (isStatic) return;
+			if (inactive) return;
+			if (articulated) return;
 
-			rotation += dquat(0, 0.5*dt*angularVelocity.x, 0.5*dt*angularVelocity.y, 0.5*dt*angularVelocity.z) * rotation;
+			if (!sleeping || forceWakeup)
+			{
+				velocity = (position - previousPosition) / dt;
+				rquat dq = rotation * inverse(previousRotation);
+				angularVelocity = real(2) / dt * rvec3(dq.x, dq.y, dq.z);
+				if (dq.w < 0) angularVelocity = -angularVelocity;
+
+				// keep the momentum state consistent
+				rmat3 R = glm::mat3_cast(rotation);
+				inertiaTensorInverse = R * inertiaTensorBodyInverse * transpose(R);
+				linearMomentum = inverseMass > 0 ? velocity / inverseMass : rvec3(0);
+				angularMomentum = inverse(inertiaTensorInverse) * angularVelocity;
+				UpdateAABB();
+			}
+
+			updateSleepParams(dt);
+			clearPseudoVelocity();
+		}
+
+		// positional impulse of the position based dynamics, moves and rotates the body directly
+		// (articulated bodies only take part in the velocity pass)
+		inline void ApplyPositionCorrection(const rvec3 linear, const rvec3 angular)
+		{
+			if (isStatic || inactive || articulated) return;
+			position += inverseMass * linear;
+			rvec3 omega = inertiaTensorInverse * angular;
+			rotation += rquat(0, 0.5*omega.x, 0.5*omega.y, 0.5*omega.z) * rotation;
 			rotation = normalize(rotation);
-			dmat3 R = glm::mat3_cast(rotation);
+			rmat3 R = glm::mat3_cast(rotation);
 			inertiaTensorInverse = R * inertiaTensorBodyInverse * transpose(R);
-
-			UpdateAABB();
+			isDirty = true;
 		}
 
-		inline double GetEffectiveMassInverse(const dvec3 J1, const dvec3 J2)
+		inline real GetEffectiveMassInverse(const rvec3 J1, const rvec3 J2)
 		{
 			return inverseMass * dot(J1, J1) + dot(J2, inertiaTensorInverse * J2);
 		}
@@ -327,20 +424,20 @@ private:
 		// coupled effective mass matrix for constraints
 		// also used for hinge
 		// J is a 12x2 matrix J=(J1, J2) Ji = (JiUpper, JiLower)'
-		inline dmat2 GetEffectiveMassInverse(const dvec3 J1Upper,const dvec3 J1Lower,const dvec3 J2Upper,const dvec3 J2Lower)
+		inline rmat2 GetEffectiveMassInverse(const rvec3 J1Upper,const rvec3 J1Lower,const rvec3 J2Upper,const rvec3 J2Lower)
 		{
-			double m11 = inverseMass * dot(J1Upper, J1Upper) + dot(J1Lower, inertiaTensorInverse * J1Lower);
-			double m22 = inverseMass * dot(J2Upper, J2Upper) + dot(J2Lower, inertiaTensorInverse * J2Lower);
-			double m12 = inverseMass * dot(J1Upper, J2Upper) + dot(J1Lower, inertiaTensorInverse * J2Lower);
+			real m11 = inverseMass * dot(J1Upper, J1Upper) + dot(J1Lower, inertiaTensorInverse * J1Lower);
+			real m22 = inverseMass * dot(J2Upper, J2Upper) + dot(J2Lower, inertiaTensorInverse * J2Lower);
+			real m12 = inverseMass * dot(J1Upper, J2Upper) + dot(J1Lower, inertiaTensorInverse * J2Lower);
 
-			dmat2 Mass(m11,m12,m12,m22);
+			rmat2 Mass(m11,m12,m12,m22);
 			return Mass;
 		}
 
 		// get 3x3 mass matrix, K=J_trans*M^-1*J_trans'
 		// used for hinge
 		// formula (48) http://danielchappuis.ch/download/ConstraintsDerivationRigidBody3D.pdf
-		inline dmat3 GetEffectiveMassInverse(const dmat3& J1, const dmat3& J2)
+		inline rmat3 GetEffectiveMassInverse(const rmat3& J1, const rmat3& J2)
 		{
 			return inverseMass*J1*transpose(J1) + J2*inertiaTensorInverse*transpose(J2);
 		}
@@ -348,62 +445,70 @@ private:
 		void UpdateDerivedState()
 		{
 			velocity = linearMomentum * inverseMass;
-			dmat3 R = glm::mat3_cast(rotation);
+			rmat3 R = glm::mat3_cast(rotation);
 			inertiaTensorInverse = R * inertiaTensorBodyInverse * transpose(R);
 			angularVelocity = inertiaTensorInverse * angularMomentum;
 		}
 		
-		inline void ApplyLinearMomentum(const dvec3 p)
+		inline void ApplyLinearMomentum(const rvec3 p)
 		{
 			if (isStatic) return;
 			this->linearMomentum += p;
 			this->velocity = this->linearMomentum * this->inverseMass;
 		}
 
-		inline void ApplyAngularMomentum(const dvec3 p)
+		inline void ApplyAngularMomentum(const rvec3 p)
 		{
 			if (isStatic) return;
 			this->angularMomentum += p;
 			this->angularVelocity = this->inertiaTensorInverse * this->angularMomentum;
 		}
 
-		void ApplyForce(dvec3 force)
+		// impulse of the split impulse position correction
+		inline void ApplyPseudoImpulse(const rvec3 linear, const rvec3 angular)
+		{
+			if (isStatic || inactive) return;
+			this->pseudoVelocity += this->inverseMass * linear;
+			this->pseudoAngularVelocity += this->inertiaTensorInverse * angular;
+		}
+
+		void ApplyForce(rvec3 force)
 		{
 			this->force += force;
 		}
 
-		void ApplyForce(dvec3 force, dvec3 pos)
+		void ApplyForce(rvec3 force, rvec3 pos)
 		{
 			this->force += force;
 			ApplyTorque(cross(pos - this->position, force));
 		}
 
-		void ApplyTorque(dvec3 torque)
+		void ApplyTorque(rvec3 torque)
 		{
 			this->torque += torque;
 		}
 		
 		//! see ~baraff/sigcourse/notesd2.pdf, D41 equation (8-1)
 		// thomaset: checked
-		dvec3 GetPointVelocity(dvec3 p)
+		rvec3 GetPointVelocity(rvec3 p)
 		{
 			return this->velocity + cross(this->angularVelocity, p - this->position);
 		}
 
-		dmat4 GetModelMatrix()
+		rmat4 GetModelMatrix()
 		{
 			if (!this->isDirty)
 			{
 				return M;
 			}
 
-			M = dmat4(1.0f); // model matrix to store translation and rotation
+			M = rmat4(1.0f); // model matrix to store translation and rotation
 
 			// apply translation
 			M = glm::translate(M, this->position);
 
 			// rotation matrix
-			dmat4 R = glm::mat4_cast(rotation);
+			rmat4 R = glm::mat4_cast(rotation);
 			M = M*R; // apply rotation
 
 			// apply scale
@@ -413,18 +518,18 @@ private:
 			return M;
 		}
 
-		const dvec3 LocalToGlobal(const dvec3 p)
+		const rvec3 LocalToGlobal(const rvec3 p)
 		{
-			dvec4 s(p, 1.0);
+			rvec4 s(p, 1.0);
 			s = GetModelMatrix()*s;
-			return dvec3(s.x,s.y,s.z);
+			return rvec3(s.x,s.y,s.z);
 		}
 
-		const dvec3 GlobalToLocal(const dvec3 p)
+		const rvec3 GlobalToLocal(const rvec3 p)
 		{
-			dvec4 s(p, 1.0);
+			rvec4 s(p, 1.0);
 			s = inverse(GetModelMatrix())*s;
-			return dvec3(s.x, s.y, s.z);
+			return rvec3(s.x, s.y, s.z);
 		}
 
 
@@ -432,7 +537,7 @@ private:
 		//
 
 		// returns the point with the highest dot product with p (needed for GJK and EPA algorithm)
-		dvec3 GetSupport(dvec3 p)
+		rvec3 GetSupport(rvec3 p)
 		{
 			// reverse model space rotation -> p is now a local direction
 			p = transpose(mat3_cast(rotation))*p;
@@ -441,10 +546,10 @@ private:
 			return LocalToGlobal(shape->GetSupport(p));
 		}
 
-		MinowskiPoint GetMinowskiSupport(dvec3 D, RigidBody* B)
+		MinowskiPoint GetMinowskiSupport(rvec3 D, RigidBody* B)
 		{
-			dvec3 s1 = GetSupport(D);
-			dvec3 s2 = B->GetSupport(-D);
+			rvec3 s1 = GetSupport(D);
+			rvec3 s2 = B->GetSupport(-D);
 			return MinowskiPoint(s1 - s2, s1);
 		}
 
@@ -457,6 +562,12 @@ private:
 
 			Contact* c = IntersectsWith(cm->bodyB);
 
+			// bodies are separated, but might collide during the next step
+			if (c == NULL && speculativeMargin + cm->bodyB->speculativeMargin > 0)
+			{
+				c = speculativeContactWith(cm->bodyB, speculativeMargin + cm->bodyB->speculativeMargin);
+			}
+
 			if (c != NULL)
 			{
 				cm->AddContact(c);
@@ -478,7 +589,7 @@ private:
 		Contact* IntersectsWith(RigidBody* B)
 		{
 			GJKSimplex s;
-			dvec3 D(1,1,1); // start with some arbitrary direction
+			rvec3 D(1,1,1); // start with some arbitrary direction
 		
 			MinowskiPoint wk = GetMinowskiSupport(D, B);
 			s.PushVertex(wk);
@@ -503,7 +614,9 @@ private:
 					return computeContact(s, B);
 				}
 
-				assert(dot(D,D) != 0);
+				// origin on the boundary of the simplex: the bodies are only touching
+				// (rare with double, happens regularly in the single precision build)
+				if (dot(D,D) == 0) return NULL;
 			}
 
 			if (maxIterations < 0) std::cout << "GJK did not converge" << std::endl;
@@ -511,13 +624,61 @@ private:
 			return NULL;
 		}
 	
+		// GJK distance algorithm, returns the distance between the bodies and their closest points (0 if they intersect)
+		// reference: Ericson, Real-Time Collision Detection, 9.5
+		real DistanceTo(RigidBody* B, rvec3& closestA, rvec3& closestB)
+		{
+			GJKSimplex s;
+
+			MinowskiPoint w = GetMinowskiSupport(rvec3(1,1,1), B);
+			s.SetPoints(w);
+			rvec3 supportA = w.support;
+			rvec3 v = w.p; // closest point of the simplex to the origin
+
+			int maxIterations = 20;
+			while (maxIterations-- > 0)
+			{
+				if (length2(v) < 1e-12) return 0; // touching
+
+				w = GetMinowskiSupport(-v, B);
+
+				// no progress towards the origin anymore -> v is the closest point
+				if (dot(v,v) - dot(v,w.p) <= 1e-6 * dot(v,v) || s.Contains(w)) break;
+
+				s.PushVertex(w);
+				v = s.ReduceToClosestPoint(supportA);
+
+				if (s.GetDimension() == 4) return 0; // origin inside, bodies intersect
+			}
+
+			closestA = supportA;
+			closestB = supportA - v;
+			return length(v);
+		}
+
+		// creates a contact with negative depth if the bodies are separated by less than margin
+		// the contact constraint allows the bodies to approach until the gap is closed
+		Contact* speculativeContactWith(RigidBody* B, real margin)
+		{
+			rvec3 closestA, closestB;
+			real distance = DistanceTo(B, closestA, closestB);
+
+			if (distance <= 0 || distance > margin) return NULL;
+
+			Contact* c = ContactPool::GetInstance().Get();
+			c->SetData(this, B, (closestB - closestA) / distance, closestA, -distance);
+			c->speculative = true;
+
+			return c;
+		}
+	
 		// EPA algorithm calculates penetration depth, location and position
 		Contact* computeContact(GJKSimplex& s, RigidBody* B)
 		{
 			EPAPolytope p = s.ConvertToEPAPolytope();
 
-			dvec3 closestToOrigin(FLT_MAX);
-			double delta = 1;
+			rvec3 closestToOrigin(FLT_MAX);
+			real delta = 1;
 
 			int maxIterations = 10000;
 			while (maxIterations-- > 0)
@@ -525,9 +686,9 @@ private:
 
 				// find closest face to origin of the polytope
 				MinowskiTriangle *f;
-				double depth;
+				real depth;
 				p.ClosestFaceToOrigin(depth, &f);
-				dvec3 normal = f->normal;
+				rvec3 normal = f->normal;
 
 				// get support point from the normal direction of the closest face
 				MinowskiPoint nextPoint = GetMinowskiSupport(normal, B);
@@ -551,15 +712,91 @@ private:
 			assert(false && "EPA did not converge");
 		}
 
+	private:
+
+		void updateSleeping()
+		{
+			if (enableSleeping && !forceWakeup)
+			{
+				if (changeAverage < sleepThreshold && length(linearMomentum) < sleepThreshold && length(angularMomentum) < sleepThreshold)
+				{
+					sleeping = true;
+
+					// artificial damping increases stability
+					linearMomentum *= 0.7;
+					angularMomentum *= 0.4;
+				}
+				else if (sleeping)
+				{
+					sleeping = false;
+				}
+			}
+		}
+
+		inline void integratePosition(real dt)
+		{
+			rvec3 v = velocity + pseudoVelocity;
+			rvec3 omega = angularVelocity + pseudoAngularVelocity;
+
+			position += dt*v;
+
+			rotation += rquat(0, 0.5*dt*omega.x, 0.5*dt*omega.y, 0.5*dt*omega.z) * rotation;
+			rotation = normalize(rotation);
+			rmat3 R = glm::mat3_cast(rotation);
+			inertiaTensorInverse = R * inertiaTensorBodyInverse * transpose(R);
+			isDirty = true;
+		}
+
+		inline void integrateVelocity(real dt)
+		{
+			angularMomentum += dt* torque;
+			linearMomentum += dt*force;
+			velocity = linearMomentum * inverseMass;
+			angularVelocity = inertiaTensorInverse * angularMomentum;
+		}
+
+		inline void clearPseudoVelocity()
+		{
+			pseudoVelocity = rvec3(0);
+			pseudoAngularVelocity = rvec3(0);
+		}
+
+		inline void updateSleepParams(real dt)
+		{
+			changeAverage = (changeAverageN/dt * changeAverage + length(velocity) + length(angularVelocity)) / (changeAverageN/dt + 1);
+			forceWakeup = false;
+		}
+
+	public:
+
 		// transforms the aabb of the shape to world coordinates
+		// refit from center/extents, avoids building the model matrix and transforming 8 corners
 		inline void UpdateAABB()
 		{
-			aabb.Set(shape->GetAABB()); // reset to untransformed
-			aabb.Transform(GetModelMatrix());
+			rmat3 RS = glm::mat3_cast(rotation);
+			RS[0] *= scale.x;
+			RS[1] *= scale.y;
+			RS[2] *= scale.z;
+			aabb.SetTransformed(shape->GetAABB(), RS, position);
 		}
 };
 int RigidBody::idCounter = 0;
 
+// orders bodies and pairs of bodies by id instead of by address, s.t. the iteration order is reproducible
+struct RigidBodyIdLess
+{
+	bool operator()(RigidBody* a, RigidBody* b) const
+	{
+		return a->GetId() < b->GetId();
+	}
+
+	bool operator()(const std::pair<RigidBody*,RigidBody*>& a, const std::pair<RigidBody*,RigidBody*>& b) const
+	{
+		if (a.first->GetId() != b.first->GetId()) return a.first->GetId() < b.first->GetId();
+		return a.second->GetId() < b.second->GetId();
+	}
+};
+
 
 // defined here because of dependency of rigidbody :/
 void Contact::Update()
@@ -574,9 +811,19 @@ void Contact::Update()
 	else type = ContactType::Colliding; // collision
 }
 
-void Contact::SetData(RigidBody* a, RigidBody* b, dvec3 normal, dvec3 loc, double depth)
+// moves the contact points with the bodies and recomputes the penetration depth (negative if separated)
+void Contact::UpdateSeparation()
+{
+	location = bodyA->LocalToGlobal(localLocation);
+	locationB = bodyB->LocalToGlobal(localLocationB);
+
+	depth = dot(normal, locationB - location);
+}
+
+void Contact::SetData(RigidBody* a, RigidBody* b, rvec3 normal, rvec3 loc, real depth)
 {
 	this->depth = depth;
+	this->speculative = false;
 
 	this->location = loc;
 	this->locationB = location - normal * depth;
@@ -605,15 +852,15 @@ void ContactManifold::UpdatePersistence()
 	{
 		Contact* c = (*i);
 
-		dvec3 newLocA = bodyA->LocalToGlobal(c->localLocation);
-		dvec3 newLocB = bodyB->LocalToGlobal(c->localLocationB);
-		dvec3 diffAB = newLocB - newLocA;
+		rvec3 newLocA = bodyA->LocalToGlobal(c->localLocation);
+		rvec3 newLocB = bodyB->LocalToGlobal(c->localLocationB);
+		rvec3 diffAB = newLocB - newLocA;
 
 		// how much did we move from original collision position?
-		dvec3 diffLocA = c->location - newLocA;
-		dvec3 diffLocB = c->locationB - newLocB;
+		rvec3 diffLocA = c->location - newLocA;
+		rvec3 diffLocB = c->locationB - newLocB;
 
-		bool penetrating = dot(c->normal, diffAB) >= 0;
+		bool penetrating = dot(c->normal, diffAB) >= 0 && !c->speculative; // speculative contacts are recomputed every time
 		
 		bool diffLocASmallEnough = length2(diffLocA) < PERSISTANCE_THRESHOLD*PERSISTANCE_THRESHOLD;
 		bool diffLocBSmallEnough = length2(diffLocB) < PERSISTANCE_THRESHOLD*PERSISTANCE_THRESHOLD;
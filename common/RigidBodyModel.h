@@ -46,6 +46,21 @@ public:
 
 	RigidBody* GetRigidBody() { return body; }
 
+	// the aabb of the body (up to date after every step)
+	virtual bool GetWorldBounds(vec3& min, vec3& max)
+	{
+		AABB aabb = body->GetAABB();
+		min = vec3(aabb.GetMin());
+		max = vec3(aabb.GetMax());
+		return true;
+	}
+
+	// static and sleeping bodies are drawn into the cached static shadow layer (until they wake up)
+	virtual bool IsStaticGeometry()
+	{
+		return body->IsStatic() || body->IsInactive();
+	}
+
 	void SetStatic()
 	{
 		this->body->SetStatic();
@@ -16,6 +16,7 @@ using namespace glm;
 #include "PhysicManager.h"
 #include "RigidBody.h"
 #include "RigidBodyModel.h"
+#include "TransformSync.h"
 
 #include "vector"
 
@@ -28,21 +29,26 @@ private:
 	std::vector<Entity*> entities;
 	std::list<Entity*> entitiesToAdd;
 
+	// rigid body models are updated in bulk by the transform sync, only the others are updated one by one
+	TransformSync transformSync;
+	std::vector<Entity*> updatedEntities;
+
 	// special entities that can exist only once
 	Camera* camera;
 	Light* light;
 	PhysicManager* physicManager;
 
 public:
-	Scene()
+	// without physics the scene only draws and updates its entities (e.g. the replay viewer)
+	Scene(bool physics = true)
 	{
 		// add physic manager
-		physicManager = new PhysicManager();
+		physicManager = physics ? new PhysicManager() : NULL;
 	}
 
 	~Scene()
 	{
-		delete physicManager;
+		if (physicManager != NULL) delete physicManager;
 
 		for (Entity* e : entities)
 		{
@@ -60,17 +66,17 @@ public:
 
 	void StartSimulation()
 	{
-		this->physicManager->Start();
+		if (physicManager != NULL) this->physicManager->Start();
 	}
 
 	void StopSimulation()
 	{
-		this->physicManager->Stop();
+		if (physicManager != NULL) this->physicManager->Stop();
 	}
 
 	void Clear()
 	{
-		physicManager->Clear();
+		if (physicManager != NULL) physicManager->Clear();
 
 		for (Entity* e : entities)
 		{
@@ -82,6 +88,8 @@ public:
 		}
 		entities.clear();
 		entitiesToAdd.clear();
+		updatedEntities.clear();
+		transformSync.Clear();
 	}
 
 	void Draw(Shader& shader)
@@ -100,6 +108,7 @@ public:
 			entitiesToAdd.pop_front();
 
 			entities.push_back(e);
+			if (!transformSync.Add(e)) updatedEntities.push_back(e);
 			addEntityToPhysicManager(e);
 		}
 	}
@@ -107,21 +116,23 @@ public:
 	void Stabalize(GLfloat T)
 	{
 		AddEntities();
-		physicManager->Stabilize(T);
+		if (physicManager != NULL) physicManager->Stabilize(T);
 	}
 
 	void Update(double dt)
 	{
 		AddEntities();
 
-		physicManager->Update(dt);
+		if (physicManager != NULL) physicManager->Update(dt);
+
+		transformSync.Sync();
 
-		int n = entities.size();
+		int n = updatedEntities.size();
 
 		//#pragma omp parallel for
 		for (int i=0; i<n; ++i)
 		{
-			Entity* e = entities[i];
+			Entity* e = updatedEntities[i];
 			e->Update(dt);
 		}
 	}
@@ -146,6 +157,7 @@ public:
 	{
 		this->camera = camera;
 		this->entities.push_back(camera);
+		this->updatedEntities.push_back(camera);
 	}
 
 	Camera* GetCamera()
@@ -157,6 +169,7 @@ public:
 	{
 		this->light = light;
 		this->entities.push_back(light);
+		this->updatedEntities.push_back(light);
 	}
 
 	Light* GetLight()
@@ -168,6 +181,8 @@ private:
 
 	void addEntityToPhysicManager(Entity* entity)
 	{
+		if (physicManager == NULL) return;
+
 		if (RigidBodyModel* model = dynamic_cast<RigidBodyModel*>(entity))
 		{
 			physicManager->AddBody(model->GetRigidBody());
@@ -2,6 +2,7 @@
 
 #include "Mesh.h"
 #include "AABB.h"
+#include "Precision.h"
 #include <vector>
 #include <list>
 
@@ -17,7 +18,7 @@ class Shape
 
 private:
 
-	dvec3* vertices; // array of vertices 
+	rvec3* vertices; // array of vertices 
 	int nVertices; // number of elements in the array of vertices
 	AABB aabb; // bounding box
 	ShapeType type;
@@ -53,7 +54,7 @@ public:
 		std::vector<Vertex> meshVertices = mesh->GetVertices();
 
 		nVertices = meshVertices.size();
-		vertices = new dvec3[meshVertices.size()];
+		vertices = new rvec3[meshVertices.size()];
 
 		for (size_t i=0; i<meshVertices.size(); ++i)
 		{
@@ -79,9 +80,9 @@ public:
 
 	// returns the vertices with the highest dot product with p, 
 	// can be overwritten for implicit shape representations for example
-	virtual void GetMultipleSupports(std::list<dvec4>& points, dvec3 p, double tol=1e-2)
+	virtual void GetMultipleSupports(std::list<rvec4>& points, rvec3 p, real tol=1e-2)
 	{
-		dvec3 pointWithMaxProduct = GetSupport(p);
+		rvec3 pointWithMaxProduct = GetSupport(p);
 		GLfloat maxProduct = dot(pointWithMaxProduct, -p);
 
 		// find with tolerance
@@ -90,14 +91,14 @@ public:
 			GLfloat d = dot(vertices[i], p);
 			if (d >= maxProduct - tol)
 			{
-				points.push_back(dvec4(vertices[i], 1.0));
+				points.push_back(rvec4(vertices[i], 1.0));
 			}
 		}
 	}
 
 	// returns the vertex with the highest dot product with p, 
 	// can be overwritten for implicit shape representations for example
-	virtual dvec3 GetSupport(dvec3 p)
+	virtual rvec3 GetSupport(rvec3 p)
 	{
 		if (type == ShapeType::Sphere)
 		{
@@ -106,7 +107,7 @@ public:
 		}
 		else if (type == ShapeType::Box)
 		{
-			return dvec3((p.x>0 ? 1 : -1)*0.5,(p.y>0 ? 1 : -1)*0.5,(p.z>0 ? 1 : -1)*0.5);
+			return rvec3((p.x>0 ? 1 : -1)*0.5,(p.y>0 ? 1 : -1)*0.5,(p.z>0 ? 1 : -1)*0.5);
 		}
 
 		GLfloat maxProduct = 0;
@@ -126,7 +127,7 @@ public:
 		return pointWithMaxProduct;
 	}
 
-	dmat3 GetInertiaTensor(GLfloat mass, vec3 scale)
+	rmat3 GetInertiaTensor(GLfloat mass, vec3 scale)
 	{
 		mat3 inertiaTensorBody;
 
@@ -143,8 +144,8 @@ public:
 				inertiaTensorBody *= std::pow(a,5);
 				break;*/
 			//return IntegrateMesh(mesh);
-				dvec3 com = CenterOfMass();
-				dmat3 inertia =  Inertia(com);
+				rvec3 com = CenterOfMass();
+				rmat3 inertia =  Inertia(com);
 				return inertia;
 
 			}
@@ -179,7 +180,7 @@ public:
 			}
 			case ShapeType::Pyramid :	// pyramid
 			{
-				dvec3 com = CenterOfMass();
+				rvec3 com = CenterOfMass();
 				inertiaTensorBody = Inertia(com);
 				break;
 			}
@@ -221,7 +222,7 @@ public:
 			{
 				assert(scale[0] == scale[1] && scale[0] == scale[2] && "inertia tensor of specialized body is not yet implemented");
 				GLfloat a = scale[0];
-				dvec3 com = CenterOfMass();
+				rvec3 com = CenterOfMass();
 				inertiaTensorBody = Inertia(com);
 				// scaling by a^5, http://gazebosim.org/tutorials?tut=inertia&cat=
 				inertiaTensorBody *= std::pow(a,5);
@@ -235,16 +236,16 @@ public:
 
 	// volume integration adapted from http://melax.github.io/volint.html
 	//
-	double Volume()
+	real Volume()
 	{
 		// count is the number of triangles (tris) 
-		double  volume=0;
+		real  volume=0;
 		for(int i=0; i < GetNumberOfFaces(); i+=3)  // for each triangle
 		{
-			dvec3 v0 = vertices[i];
-			dvec3 v1 = vertices[i+1];
-			dvec3 v2 = vertices[i+2];
-			volume += determinant(dmat3(v0,v1,v2)); //divide by 6 later for efficiency
+			rvec3 v0 = vertices[i];
+			rvec3 v1 = vertices[i+1];
+			rvec3 v2 = vertices[i+2];
+			volume += determinant(rmat3(v0,v1,v2)); //divide by 6 later for efficiency
 		}
 		return volume/6.0f;  // since the determinant give 6 times tetra volume
 	}
@@ -252,21 +253,21 @@ public:
 
 	// com integration adapted from http://melax.github.io/volint.html
 	//
-	dvec3 CenterOfMass()
+	rvec3 CenterOfMass()
 	{
 		// count is the number of triangles (tris) 
-		dvec3 com(0,0,0);
-		double  volume=0; // actually accumulates the volume*6
+		rvec3 com(0,0,0);
+		real  volume=0; // actually accumulates the volume*6
 
 		for(int i=0; i < GetNumberOfFaces(); i+=3)  // for each triangle
 		{
-			dvec3 v0 = vertices[i];
-			dvec3 v1 = vertices[i+1];
-			dvec3 v2 = vertices[i+2];
+			rvec3 v0 = vertices[i];
+			rvec3 v1 = vertices[i+1];
+			rvec3 v2 = vertices[i+2];
 
-			dmat3 A(v0,v1,v2);
+			rmat3 A(v0,v1,v2);
 
-			double vol=determinant(A);  // dont bother to divide by 6 
+			real vol=determinant(A);  // dont bother to divide by 6 
 
 			//com += vol * (A.x+A.y+A.z);  // divide by 4 at end
 			com += vol * (v0+v1+v2);
@@ -279,23 +280,23 @@ public:
 
 	// inertia integration adapted from http://melax.github.io/volint.html
 	//
-	dmat3 Inertia(dvec3 com)
+	rmat3 Inertia(rvec3 com)
 	{
 		// count is the number of triangles (tris) 
 		// The moments are calculated based on the center of rotation com which you should calculate first
 		// assume mass==1.0  you can multiply by mass later.
 		// for improved accuracy the next 3 variables, the determinant d, and its calculation should be changed to double
 		float  volume=0;                          // technically this variable accumulates the volume times 6
-		dvec3 diag(0,0,0);                       // accumulate matrix main diagonal integrals [x*x, y*y, z*z]
-		dvec3 offd(0,0,0);                       // accumulate matrix off-diagonal  integrals [y*z, x*z, x*y]
+		rvec3 diag(0,0,0);                       // accumulate matrix main diagonal integrals [x*x, y*y, z*z]
+		rvec3 offd(0,0,0);                       // accumulate matrix off-diagonal  integrals [y*z, x*z, x*y]
 
 		for(int i=0; i < GetNumberOfFaces(); i+=3)  // for each triangle
 		{
-			dvec3 v0 = vertices[i];
-			dvec3 v1 = vertices[i+1];
-			dvec3 v2 = vertices[i+2];
+			rvec3 v0 = vertices[i];
+			rvec3 v1 = vertices[i+1];
+			rvec3 v2 = vertices[i+2];
 
-			dmat3 A(v0-com, v1-com, v2-com); // matrix trick for volume calc by taking determinant
+			rmat3 A(v0-com, v1-com, v2-com); // matrix trick for volume calc by taking determinant
 			float    d = determinant(A);  // vol of tiny parallelapiped= d * dr * ds * dt (the 3 partials of my tetral triple integral equasion)
 			volume +=d;                   // add vol of current tetra (note it could be negative - that's ok we need that sometimes)
 
@@ -312,7 +313,7 @@ public:
 		}
 		diag /= volume*(60.0f /6.0f);  // divide by total volume (vol/6) since density=1/volume
 		offd /= volume*(120.0f/6.0f);
-		return dmat3(diag.y+diag.z  , -offd.z      , -offd.y,
+		return rmat3(diag.y+diag.z  , -offd.z      , -offd.y,
 					-offd.z        , diag.x+diag.z, -offd.x,
 					-offd.y        , -offd.x      , diag.x+diag.y );
 	}
@@ -0,0 +1,133 @@
+/*
+ * Publishes the transforms of all bodies after every step into POSIX shared memory (layout: see
+ * SharedTransformFormat.h), other processes read them with SharedTransformReader without copies or sockets.
+ * Publishing is a plain write into the next ring slot, the physics thread never waits for a reader.
+ */
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <algorithm>
+#include <iostream>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "RigidBody.h"
+#include "SharedTransformFormat.h"
+
+class SharedTransformExporter
+{
+
+private:
+	std::string name;
+	void* memory = NULL;
+	size_t size = 0;
+	SharedTransformHeader* header = NULL;
+
+	uint64_t step = 0;
+	double time = 0;
+
+public:
+
+	// name: shared memory object (shm_open), capacity: maximal number of exported bodies
+	SharedTransformExporter(const char* name = SHARED_TRANSFORM_NAME, uint32_t capacity = SHARED_TRANSFORM_CAPACITY, uint32_t slotCount = SHARED_TRANSFORM_SLOTS)
+	{
+		this->name = name;
+		slotCount = std::max(slotCount, (uint32_t)2);
+		size = SharedTransformSize(capacity, slotCount);
+
+		int fd = shm_open(name, O_CREAT | O_RDWR, 0644);
+		if (fd < 0)
+		{
+			std::cout << "could not create shared memory " << name << std::endl;
+			return;
+		}
+		if (ftruncate(fd, size) != 0)
+		{
+			std::cout << "could not resize shared memory " << name << std::endl;
+			close(fd);
+			shm_unlink(name);
+			return;
+		}
+
+		memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		close(fd); // the mapping stays valid
+		if (memory == MAP_FAILED)
+		{
+			std::cout << "could not map shared memory " << name << std::endl;
+			memory = NULL;
+			shm_unlink(name);
+			return;
+		}
+
+		// the magic is written last: readers that attach while the header is written see an invalid header
+		memset(memory, 0, size);
+		header = (SharedTransformHeader*)memory;
+		header->version = SHARED_TRANSFORM_VERSION;
+		header->capacity = capacity;
+		header->slotCount = slotCount;
+		header->latest.store(0);
+		std::atomic_thread_fence(std::memory_order_release);
+		header->magic = SHARED_TRANSFORM_MAGIC;
+	}
+
+	// removes the shared memory object, readers that are still attached keep their mapping
+	~SharedTransformExporter()
+	{
+		if (memory == NULL) return;
+		munmap(memory, size);
+		shm_unlink(name.c_str());
+	}
+
+	bool IsOpen() { return memory != NULL; }
+	uint64_t GetStepCount() { return step; }
+
+	// writes the transforms of the bodies into the next slot, dt: simulated time since the last step
+	void Publish(std::vector<RigidBody*>& bodies, real dt)
+	{
+		if (memory == NULL) return;
+
+		time += dt;
+		SharedTransformSlot* slot = SharedTransformGetSlot(memory, step % header->slotCount);
+		SharedTransform* transforms = SharedTransformGetTransforms(slot);
+
+		// seqlock: odd while writing, the release fence orders the payload after the odd sequence
+		uint32_t sequence = slot->sequence.load(std::memory_order_relaxed);
+		slot->sequence.store(sequence + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		uint32_t n = std::min((uint32_t)bodies.size(), header->capacity);
+		slot->bodyCount = n;
+		slot->totalBodies = bodies.size();
+		slot->step = step;
+		slot->time = time;
+
+		for (uint32_t i=0; i<n; ++i)
+		{
+			RigidBody* b = bodies[i];
+			rvec3 p = b->GetPosition();
+			rquat r = b->GetRotation();
+
+			SharedTransform& t = transforms[i];
+			t.id = b->GetId();
+			t.flags = (b->IsStatic() ? SharedTransformStatic : 0) | (b->IsInactive() ? SharedTransformSleeping : 0);
+			t.position[0] = p.x;
+			t.position[1] = p.y;
+			t.position[2] = p.z;
+			t.rotation[0] = r.x;
+			t.rotation[1] = r.y;
+			t.rotation[2] = r.z;
+			t.rotation[3] = r.w;
+		}
+
+		slot->sequence.store(sequence + 2, std::memory_order_release);
+
+		++step;
+		header->latest.store(step, std::memory_order_release);
+	}
+};
@@ -0,0 +1,80 @@
+/*
+ * Layout of the shared memory the body transforms are published to (by SharedTransformExporter, read with
+ * SharedTransformReader by other processes)
+ *
+ * SharedTransformHeader, then slotCount slots of (SharedTransformSlot + capacity*SharedTransform).
+ * The slots are a ring: step n is written to slot n % slotCount, so a reader of the latest step is only
+ * overwritten slotCount-1 steps later. Every slot is guarded by a seqlock: the sequence is odd while the slot
+ * is written, a reader that sees the same even sequence before and after reading got a consistent step.
+ * The writer never waits for the readers.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+
+#define SHARED_TRANSFORM_MAGIC 0x54584850 // "PHXT"
+#define SHARED_TRANSFORM_VERSION 1
+#define SHARED_TRANSFORM_NAME "/physics_transforms"
+#define SHARED_TRANSFORM_CAPACITY 4096
+#define SHARED_TRANSFORM_SLOTS 3
+
+// the atomics are shared between processes, this is only valid for lock free atomics
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "atomic<uint32_t> must be a plain 32 bit value");
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t), "atomic<uint64_t> must be a plain 64 bit value");
+
+struct SharedTransformHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t capacity; // transforms per slot
+	uint32_t slotCount;
+	std::atomic<uint64_t> latest; // last completely written step + 1 (0: nothing written yet)
+};
+
+struct SharedTransformSlot
+{
+	std::atomic<uint32_t> sequence; // odd while written
+	uint32_t bodyCount; // <= capacity
+	uint32_t totalBodies; // bodies of the simulation (more than bodyCount if the capacity is exceeded)
+	uint32_t reserved;
+	uint64_t step;
+	double time; // simulated time
+};
+
+struct SharedTransform
+{
+	int32_t id; // RigidBody::GetId
+	uint32_t flags; // SharedTransformFlags
+	float position[3];
+	float rotation[4]; // quaternion x, y, z, w
+};
+
+enum SharedTransformFlags
+{
+	SharedTransformStatic = 1,
+	SharedTransformSleeping = 2
+};
+
+inline size_t SharedTransformSlotSize(uint32_t capacity)
+{
+	// padded, s.t. the next slot is 8 byte aligned
+	return (sizeof(SharedTransformSlot) + capacity * sizeof(SharedTransform) + 7) & ~(size_t)7;
+}
+
+inline size_t SharedTransformSize(uint32_t capacity, uint32_t slotCount)
+{
+	return sizeof(SharedTransformHeader) + slotCount * SharedTransformSlotSize(capacity);
+}
+
+inline SharedTransformSlot* SharedTransformGetSlot(void* memory, uint32_t index)
+{
+	SharedTransformHeader* h = (SharedTransformHeader*)memory;
+	return (SharedTransformSlot*)((char*)memory + sizeof(SharedTransformHeader) + index * SharedTransformSlotSize(h->capacity));
+}
+
+inline SharedTransform* SharedTransformGetTransforms(SharedTransformSlot* slot)
+{
+	return (SharedTransform*)(slot + 1);
+}
@@ -0,0 +1,159 @@
+/*
+ * Reader for the body transforms published by SharedTransformExporter (layout: see SharedTransformFormat.h)
+ * Only depends on the layout, external processes include this header and SharedTransformFormat.h.
+ *
+ * Zero copy reading of the latest step:
+ *   SharedTransformView v;
+ *   if (reader.Acquire(v)) { ... read v.transforms[0..v.count) ... if (!reader.Validate(v)) discard results; }
+ * ReadLatest copies the latest consistent step (and retries if the writer overwrote it meanwhile).
+ */
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <algorithm>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "SharedTransformFormat.h"
+
+struct SharedTransformView
+{
+	const SharedTransform* transforms;
+	uint32_t count;
+	uint32_t totalBodies;
+	uint64_t step;
+	double time;
+
+	// seqlock state to validate the view
+	const SharedTransformSlot* slot;
+	uint32_t sequence;
+};
+
+class SharedTransformReader
+{
+
+private:
+	std::string name;
+	void* memory = NULL;
+	size_t size = 0;
+	const SharedTransformHeader* header = NULL;
+
+public:
+
+	SharedTransformReader(const char* name = SHARED_TRANSFORM_NAME)
+	{
+		this->name = name;
+		Open();
+	}
+
+	~SharedTransformReader()
+	{
+		Close();
+	}
+
+	// attaches to the shared memory (false if the exporter did not create it yet)
+	bool Open()
+	{
+		if (memory != NULL) return true;
+
+		int fd = shm_open(name.c_str(), O_RDONLY, 0);
+		if (fd < 0) return false;
+
+		struct stat st;
+		if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(SharedTransformHeader))
+		{
+			close(fd);
+			return false;
+		}
+
+		void* p = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+		close(fd);
+		if (p == MAP_FAILED) return false;
+
+		// the exporter writes the magic last
+		const SharedTransformHeader* h = (const SharedTransformHeader*)p;
+		bool valid = h->magic == SHARED_TRANSFORM_MAGIC;
+		std::atomic_thread_fence(std::memory_order_acquire);
+		valid = valid && h->version == SHARED_TRANSFORM_VERSION && h->slotCount > 0 &&
+			SharedTransformSize(h->capacity, h->slotCount) <= (size_t)st.st_size;
+		if (!valid)
+		{
+			munmap(p, st.st_size);
+			return false;
+		}
+
+		memory = p;
+		size = st.st_size;
+		header = h;
+		return true;
+	}
+
+	void Close()
+	{
+		if (memory != NULL) munmap(memory, size);
+		memory = NULL;
+		header = NULL;
+		size = 0;
+	}
+
+	bool IsOpen() { return memory != NULL; }
+
+	// number of published steps (0: nothing published yet)
+	uint64_t GetLatestStep()
+	{
+		if (memory == NULL) return 0;
+		return header->latest.load(std::memory_order_acquire);
+	}
+
+	// view into the shared memory of the latest step, false if nothing is published or the slot is written
+	bool Acquire(SharedTransformView& v)
+	{
+		uint64_t latest = GetLatestStep();
+		if (latest == 0) return false;
+
+		const SharedTransformSlot* slot = SharedTransformGetSlot(memory, (latest - 1) % header->slotCount);
+		uint32_t sequence = slot->sequence.load(std::memory_order_acquire);
+		if (sequence & 1) return false;
+
+		v.slot = slot;
+		v.sequence = sequence;
+		v.count = std::min(slot->bodyCount, header->capacity);
+		v.totalBodies = slot->totalBodies;
+		v.step = slot->step;
+		v.time = slot->time;
+		v.transforms = SharedTransformGetTransforms((SharedTransformSlot*)slot);
+		return true;
+	}
+
+	// true if the writer did not touch the slot since Acquire, i.e. everything read from the view is consistent
+	bool Validate(const SharedTransformView& v)
+	{
+		std::atomic_thread_fence(std::memory_order_acquire);
+		return v.slot->sequence.load(std::memory_order_relaxed) == v.sequence;
+	}
+
+	// copies the latest consistent step
+	bool ReadLatest(std::vector<SharedTransform>& transforms, uint64_t& step, double& time, int maxTries = 100)
+	{
+		for (int i=0; i<maxTries; ++i)
+		{
+			SharedTransformView v;
+			if (!Acquire(v)) continue;
+
+			transforms.resize(v.count);
+			if (v.count > 0) memcpy(&transforms[0], v.transforms, v.count * sizeof(SharedTransform));
+			if (!Validate(v)) continue;
+
+			step = v.step;
+			time = v.time;
+			return true;
+		}
+		return false;
+	}
+};
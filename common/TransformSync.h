@@ -0,0 +1,139 @@
+/*
+ * Bulk transform sync from the rigid bodies to the rendered models.
+ * Replaces the virtual RigidBodyModel::Update of every model (float conversion and parent walk): the model
+ * matrices are computed directly from the body state and written into the instance matrices of the master
+ * model, the draw call uploads them without gathering. Bodies whose pose did not change are skipped.
+ * Only models without parent are synced, the others keep their own Update.
+ */
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+using namespace glm;
+
+#include <vector>
+#include <unordered_map>
+
+#include "RigidBodyModel.h"
+
+class TransformSync
+{
+
+private:
+	struct Entry
+	{
+		RigidBodyModel* model;
+		RigidBody* body;
+		int master; // index in masters
+		int slot;
+		bool synced; // matrix written at least once
+		bool changed; // in the last sync
+		rvec3 position; // synced transform
+		rquat rotation;
+	};
+
+	struct Master
+	{
+		Model* model;
+		int registered; // number of synced models of the master (the master itself and its instances)
+		mat4* matrices;
+	};
+
+	std::vector<Entry> entries;
+	std::vector<Master> masters;
+	std::unordered_map<Model*, int> masterIndex;
+
+public:
+
+	// true if the entity is synced (and needs no Update)
+	bool Add(Entity* entity)
+	{
+		RigidBodyModel* model = dynamic_cast<RigidBodyModel*>(entity);
+		if (model == NULL || model->GetParent() != NULL) return false;
+
+		Model* master = model->GetMaster();
+		std::unordered_map<Model*, int>::iterator i = masterIndex.find(master);
+		if (i == masterIndex.end())
+		{
+			Master m = { master, 0, NULL };
+			i = masterIndex.insert(std::make_pair(master, (int)masters.size())).first;
+			masters.push_back(m);
+		}
+		masters[i->second].registered++;
+
+		Entry e;
+		e.model = model;
+		e.body = model->GetRigidBody();
+		e.master = i->second;
+		e.slot = model->GetInstanceSlot();
+		e.synced = false;
+		e.changed = false;
+		entries.push_back(e);
+		return true;
+	}
+
+	void Clear()
+	{
+		entries.clear();
+		masters.clear();
+		masterIndex.clear();
+	}
+
+	void Sync()
+	{
+		// the matrix arrays grow with new instances, resize them before the parallel pass
+		for (Master& m : masters)
+		{
+			m.matrices = m.model->GetInstanceMatrices();
+		}
+
+		int n = entries.size();
+
+		#pragma omp parallel for
+		for (int i=0; i<n; ++i)
+		{
+			Entry& e = entries[i];
+			RigidBody* b = e.body;
+			rvec3 p = b->GetPosition();
+			rquat r = b->GetRotation();
+
+			// decided from the pose only: resting bodies (sleeping, static or at rest while active) are skipped
+			e.changed = !e.synced || !(p == e.position) || !(r == e.rotation);
+			if (!e.changed) continue;
+
+			// M = translate * rotate * scale
+			quat q = normalize(quat(r));
+			mat3 R = mat3_cast(q);
+			vec3 s = e.model->GetScale();
+			vec3 t(p);
+
+			mat4 M;
+			M[0] = vec4(R[0] * s.x, 0);
+			M[1] = vec4(R[1] * s.y, 0);
+			M[2] = vec4(R[2] * s.z, 0);
+			M[3] = vec4(t, 1);
+
+			masters[e.master].matrices[e.slot] = M;
+			e.model->SetTransform(t, q, M);
+
+			e.synced = true;
+			e.position = p;
+			e.rotation = r;
+		}
+
+		// only the changed slots are uploaded (the instances of a master are mostly added one after another,
+		// the changed slots of the moving ones are ranges)
+		for (int i=0; i<n; ++i)
+		{
+			Entry& e = entries[i];
+			if (e.changed) masters[e.master].model->MarkInstancesDirty(e.slot, e.slot+1);
+		}
+
+		// masters with models that are not synced (e.g. in a hierarchy) gather the matrices in the draw call
+		for (Master& m : masters)
+		{
+			m.model->SetMatricesSynced(m.registered == m.model->GetInstanceCount() + 1);
+		}
+	}
+};
@@ -139,9 +139,15 @@ protected:
 		}
 	}
 
+	// broad phase test, the boxes are enlarged by the speculative margins of the bodies
+	inline bool broadPhaseIntersects(RigidBody* a, RigidBody* b)
+	{
+		return a->aabb.IntersectsWith(b->aabb, a->speculativeMargin + b->speculativeMargin);
+	}
+
 	std::pair<int,int> getPairIndex(RigidBody* a, RigidBody *b )
 	{
-		if (a < b) 	return std::make_pair(a->id, b->id);
+		if (a->id < b->id) 	return std::make_pair(a->id, b->id);
 		else	 	return std::make_pair(b->id, a->id);
 	}
 };
@@ -168,7 +174,7 @@ public:
 				if (a->id >= b->id) continue; 
 
 				// broad collision detection
-				if (a->aabb.IntersectsWith(b->aabb))
+				if (broadPhaseIntersects(a, b))
 				{
 					narrowPhase(a,b);
 				}
@@ -183,7 +189,7 @@ private:
 	std::vector<RigidBody*> axisx;
 	std::vector<RigidBody*> axisy;
 	std::vector<RigidBody*> axisz;
-	std::set<std::pair<RigidBody*,RigidBody*>> broadCollisions; // cache of all created manifolds
+	std::set<std::pair<RigidBody*,RigidBody*>, RigidBodyIdLess> broadCollisions; // cache of all created manifolds
 	std::vector<RigidBody*> active;
 	bool initial = true;
 
@@ -219,12 +225,12 @@ public:
 		{
 			RigidBody* a = axis[i];	
 
-			double val = a->aabb.min[dim];
+			real val = a->aabb.min[dim] - a->speculativeMargin;
 
 			int j = i-1;
 
 			// move body left until it is in the right position
-			while(j >= 0 && axis[j]->aabb.min[dim] > val)
+			while(j >= 0 && axis[j]->aabb.min[dim] - axis[j]->speculativeMargin > val)
 			{
 				RigidBody* b = axis[j];
 
@@ -239,7 +245,7 @@ public:
 				if (a->id < b->id) 	p = std::make_pair(a, b);
 				else	 			p = std::make_pair(b, a);
 
-				if (a->aabb.IntersectsWith(b->aabb))
+				if (broadPhaseIntersects(a, b))
 				{
 					broadCollisions.insert(p);
 				}
@@ -267,7 +273,7 @@ public:
 				if (a->id >= b->id) continue; 
 
 				// broad collision detection
-				if (a->aabb.IntersectsWith(b->aabb))
+				if (broadPhaseIntersects(a, b))
 				{
 					broadCollisions.insert(std::make_pair(a,b));
 				}
@@ -275,13 +281,13 @@ public:
 		}
 
 		std::sort(axisx.begin(), axisx.end(), [](const RigidBody* a, const RigidBody* b){
-			return a->aabb.min.x < b->aabb.min.x;
+			return a->aabb.min.x - a->speculativeMargin < b->aabb.min.x - b->speculativeMargin;
 		});
 		std::sort(axisy.begin(), axisy.end(), [](const RigidBody* a, const RigidBody* b){
-			return a->aabb.min.y < b->aabb.min.y;
+			return a->aabb.min.y - a->speculativeMargin < b->aabb.min.y - b->speculativeMargin;
 		});
 		std::sort(axisz.begin(), axisz.end(), [](const RigidBody* a, const RigidBody* b){
-			return a->aabb.min.z < b->aabb.min.z;
+			return a->aabb.min.z - a->speculativeMargin < b->aabb.min.z - b->speculativeMargin;
 		});
 	}
 
@@ -325,7 +331,7 @@ public:
 		active.clear();
 
 		std::sort(bodies.begin(), bodies.end(), [](const RigidBody* a, const RigidBody* b){
-			return a->aabb.min.x < b->aabb.min.x;
+			return a->aabb.min.x - a->speculativeMargin < b->aabb.min.x - b->speculativeMargin;
 		});
 
 
@@ -336,14 +342,14 @@ public:
 			{
 				RigidBody* b = (*it);
 
-				if (a->aabb.min.x > b->aabb.max.x)
+				if (a->aabb.min.x - a->speculativeMargin > b->aabb.max.x + b->speculativeMargin)
 				{
 					active.erase(std::next(it).base());
 				}
 
 				++it;
 
-				if (a->aabb.IntersectsWith(b->aabb))
+				if (broadPhaseIntersects(a, b))
 				{
 					// dont compare static or with itself
 					if (a->inverseMass == 0 && b->inverseMass == 0) continue;
@@ -364,9 +370,9 @@ public:
 class SpatialPartitioningCollisionDetector : public CollisionDetector
 {
 private:
-	dvec3 resolution; // 1 means unit volumes, 2 means 2^2 volumes per unit volume
+	rvec3 resolution; // 1 means unit volumes, 2 means 2^2 volumes per unit volume
 	std::unordered_map<ivec3, std::vector<RigidBody*>, IVec3Op> map;
-	std::set<std::pair<RigidBody*,RigidBody*>> broadCollisions;
+	std::set<std::pair<RigidBody*,RigidBody*>, RigidBodyIdLess> broadCollisions;
 
 	int numberOfUsedContacts = 0;
 	int broadIntersections = 0;
@@ -377,7 +383,7 @@ public:
 
 	SpatialPartitioningCollisionDetector(InactivityDetector* inactivityDetector) : CollisionDetector(inactivityDetector)
 	{
-		resolution = dvec3(0.9,1,0.9); // lower resolution in x and z because the floor needs a lot of space
+		resolution = rvec3(0.9,1,0.9); // lower resolution in x and z because the floor needs a lot of space
 	}
 
 	virtual void Clear()
@@ -446,7 +452,7 @@ private:
 			if (a->inverseMass == 0 && b->inverseMass == 0) continue;
 
 			// broad collision detection
-			if (a->aabb.IntersectsWith(b->aabb))
+			if (broadPhaseIntersects(a, b))
 			{
 				std::pair<RigidBody*, RigidBody*> p;
 				if (a->id < b->id) 	p = std::make_pair(a, b);
@@ -465,8 +471,9 @@ private:
 	{
 		AABB& box = b->aabb;
 
-		dvec3 min = resolution * box.GetMin();
-		dvec3 max = resolution * box.GetMax();
+		// enlarge by the speculative margin, s.t. close bodies share a volume
+		rvec3 min = resolution * (box.GetMin() - rvec3(b->speculativeMargin));
+		rvec3 max = resolution * (box.GetMax() + rvec3(b->speculativeMargin));
 
 		int minx = floor(min.x);
 		int miny = floor(min.y);
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include "Precision.h"
+
 class RigidBody; // forward declaration
 class ContactConstraint; 
 
@@ -23,25 +25,26 @@ public:
 		RigidBody* bodyA;
 		RigidBody* bodyB;
 
-		dvec3 normal;
-		dvec3 location; // location on a face of body a
-		dvec3 localLocation; // location in shape space of body a
+		rvec3 normal;
+		rvec3 location; // location on a face of body a
+		rvec3 localLocation; // location in shape space of body a
 
-		dvec3 locationB; // location on a face of body b
-		dvec3 localLocationB; // location in shape space of body b
+		rvec3 locationB; // location on a face of body b
+		rvec3 localLocationB; // location in shape space of body b
 
-		dvec3 tangent1;
-		dvec3 tangent2;
+		rvec3 tangent1;
+		rvec3 tangent2;
 
 		ContactConstraint* constraint;
 
-		double depth;
+		real depth; // negative for speculative contacts (distance between the bodies)
+		bool speculative = false; // bodies are not touching yet
 
 
 		// calculated via Update()
-		dvec3 vA;
-		dvec3 vB;
-		double vRel;
+		rvec3 vA;
+		rvec3 vB;
+		real vRel;
 		ContactType type;
 
 		// implemented in ContactConstraint because of dependency
@@ -51,11 +54,14 @@ public:
 
 		// calculates vA, vB, vRel and type and needs to be updated every time the velocity or angular velocity of one of the bodies changed
 		void Update(); // defined in rigidbody.h
-		void SetData(RigidBody* a, RigidBody* b, dvec3 normal, dvec3 loc, double depth); // defined in RigidBody.h
+
+		// recalculates location, locationB and depth from the local locations after the bodies moved
+		void UpdateSeparation(); // defined in RigidBody.h
+		void SetData(RigidBody* a, RigidBody* b, rvec3 normal, rvec3 loc, real depth); // defined in RigidBody.h
 		
 		void PrintContact(); // defined in RigidBody.h
 
-		void SetNormal(dvec3 normal)
+		void SetNormal(rvec3 normal)
 		{
 			this->normal = normal;
 			normal = normalize(normal);
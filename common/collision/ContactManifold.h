@@ -5,6 +5,7 @@
 #pragma once
 
 #include <algorithm>
+#include <cfloat>
 
 #include <glm/glm.hpp>
 #include <glm/gtx/norm.hpp>
@@ -12,6 +13,7 @@
 #include "collision/Contact.h"
 
 class RigidBody; // forward declaration
+class ContactManifoldConstraint;
 
 using namespace glm;
 
@@ -24,18 +26,13 @@ public:
 		std::list<Contact*> contacts;
 		RigidBody* bodyA;
 		RigidBody* bodyB;
-		dvec3 normal;
+		rvec3 normal;
 		bool persistent = false;
+		ContactManifoldConstraint* constraint; // block solver for the normal impulses
 
-		ContactManifold()
-		{
-
-		}
-
-		~ContactManifold()
-		{
-			Clear();
-		}
+		// implemented in ContactManifoldConstraint because of dependency
+		ContactManifold();
+		~ContactManifold();
 
 		void Clear()
 		{
@@ -88,7 +85,7 @@ public:
 			// find 4 good contacts:
 			
 			// deepest
-			double maxDepth = 0;
+			real maxDepth = -DBL_MAX;
 
 			Contact* c1;
 			for (Contact *c : contacts)
@@ -101,11 +98,11 @@ public:
 			}
 
 			// most far away from deepest
-			double maxDst = 0;
+			real maxDst = 0;
 			Contact* c2;
 			for (Contact *c : contacts)
 			{
-				double currDst = length2(c->location - c1->location);
+				real currDst = length2(c->location - c1->location);
 				if (currDst >= maxDst)
 				{
 					maxDst = currDst;	
@@ -116,12 +113,12 @@ public:
 			// furthest from line between c1 and c2
 			maxDst = 0;
 			Contact* c3;
-			dvec3 n = normalize(c2->location - c1->location);
+			rvec3 n = normalize(c2->location - c1->location);
 
 			for (Contact *c : contacts)
 			{
-				dvec3 q = c1->location - c->location;
-				double currDst = length2(q - dot(q,n)*n);
+				rvec3 q = c1->location - c->location;
+				real currDst = length2(q - dot(q,n)*n);
 				if (currDst >= maxDst)
 				{
 					maxDst = currDst;
@@ -138,25 +135,25 @@ public:
 			{
 				//distance from triangle (c1,c2,c3) 
 
-				dvec3 v0 = c2->location - c1->location;
-				dvec3 v1 = c3->location - c1->location;
-				dvec3 v2 = c->location - c1->location;
+				rvec3 v0 = c2->location - c1->location;
+				rvec3 v1 = c3->location - c1->location;
+				rvec3 v2 = c->location - c1->location;
 
-				double d00 = dot(v0, v0);
-				double d01 = dot(v0, v1);
-				double d11 = dot(v1, v1);
-				double d20 = dot(v2, v0);
-				double d21 = dot(v2, v1);
-				double denom = d00 * d11 - d01 * d01;
-				double v = (d11 * d20 - d01 * d21) / denom;
-				double w = (d00 * d21 - d01 * d20) / denom;
-				double u = 1.0f - v - w;
+				real d00 = dot(v0, v0);
+				real d01 = dot(v0, v1);
+				real d11 = dot(v1, v1);
+				real d20 = dot(v2, v0);
+				real d21 = dot(v2, v1);
+				real denom = d00 * d11 - d01 * d01;
+				real v = (d11 * d20 - d01 * d21) / denom;
+				real w = (d00 * d21 - d01 * d20) / denom;
+				real u = 1.0f - v - w;
 
 				Clamp(u,0,1);
 				Clamp(v,0,1);
 				Clamp(w,0,1);
 
-				double currDst = length2(u*c->location + v*c->location + w*c->location - c->location);
+				real currDst = length2(u*c->location + v*c->location + w*c->location - c->location);
 
 				if (currDst >= maxDst)
 				{
@@ -197,7 +194,7 @@ public:
 			}
 		}
 
-		void Clamp(double &val, double min, double max)
+		void Clamp(real &val, real min, real max)
 		{
 			if (val < min) val = min;	
 			else if (val > max) val = max;	
@@ -29,14 +29,14 @@ public:
 		triangles.push_back(MinowskiTriangle(a,b,c));
 	}
 
-	void ClosestFaceToOrigin(double& shortestDst, MinowskiTriangle** closestFace)
+	void ClosestFaceToOrigin(real& shortestDst, MinowskiTriangle** closestFace)
 	{
 		shortestDst = FLT_MAX;
 		
 		auto i = triangles.begin();
 		while (i != triangles.end())
 		{
-			double dst = dot(i->normal, i->a.p);
+			real dst = dot(i->normal, i->a.p);
 
 			if (std::abs(dst) < std::abs(shortestDst))
 			{
@@ -7,6 +7,8 @@ using namespace glm;
 #include <collision/MinowskiPoint.h>
 #include <collision/EPAPolytope.h>
 
+#include <cfloat>
+
 
 /* 
  * Simplex helper class of up to 4-Simplex for the GJK algorithm
@@ -63,6 +65,14 @@ public:
 		points[3] = d;
 	}
 
+	int GetDimension() { return dim; }
+
+	bool Contains(const MinowskiPoint& v)
+	{
+		for (int i=0; i<dim; ++i) if (points[i].p == v.p) return true;
+		return false;
+	}
+
 	void PushVertex(MinowskiPoint v)
 	{
 		for (int i=0; i<dim; ++i) assert(points[i].p != v.p);
@@ -78,9 +88,9 @@ public:
 
 
 	// finds the direction to the origin from the nearest point on the simplex from the origin on the simplex
-	bool HasOriginInside(dvec3& dir)
+	bool HasOriginInside(rvec3& dir)
 	{
-		dvec3 ao = -points[0].p; // vector from a to origin
+		rvec3 ao = -points[0].p; // vector from a to origin
 
 		switch(dim)
 		{
@@ -90,9 +100,9 @@ public:
 
 			case 2:  // we have a line; choose the direction pointing to the origin
 			{
-				dvec3 ab = points[1].p - points[0].p; // vector from a to b
+				rvec3 ab = points[1].p - points[0].p; // vector from a to b
 
-				dvec3 abao = cross(ab,ao);
+				rvec3 abao = cross(ab,ao);
 
 				if (abao.x == 0 && abao.y == 0 && abao.z == 0) // the origin lies in out line between p0 and p1
 				{
@@ -106,10 +116,10 @@ public:
 
 			case 4:
 			{
-				dvec3 ab = points[1].p - points[0].p; // vector from a to b
-				dvec3 ac = points[2].p - points[0].p; // vector from a to c
+				rvec3 ab = points[1].p - points[0].p; // vector from a to b
+				rvec3 ac = points[2].p - points[0].p; // vector from a to c
 
-				dvec3 abcn = cross(ab,ac); // normal of abc triangle
+				rvec3 abcn = cross(ab,ac); // normal of abc triangle
 				if (dot(abcn, ao) > 0)
 				{
 					// origin is in front of abc
@@ -118,8 +128,8 @@ public:
 					return false;
 				}
 
-				dvec3 ad = points[3].p - points[0].p; // vector from a to d
-				dvec3 acdn = cross(ac,ad); // normal of acd triangle
+				rvec3 ad = points[3].p - points[0].p; // vector from a to d
+				rvec3 acdn = cross(ac,ad); // normal of acd triangle
 
 				if (dot(acdn, ao) > 0)
 				{
@@ -129,7 +139,7 @@ public:
 					return false;
 				}
 
-				dvec3 adbn = cross(ad,ab); // normal of acd triangle
+				rvec3 adbn = cross(ad,ab); // normal of acd triangle
 
 				if (dot(adbn, ao) > 0)
 				{
@@ -145,11 +155,11 @@ public:
 			
 			case 3: // we have a triangle
 			{
-				dvec3 ab = points[1].p - points[0].p; // vector from a to b
-				dvec3 ac = points[2].p - points[0].p; // vector from a to c
-				dvec3 n = cross(ab,ac); // normal of triangle
+				rvec3 ab = points[1].p - points[0].p; // vector from a to b
+				rvec3 ac = points[2].p - points[0].p; // vector from a to c
+				rvec3 n = cross(ab,ac); // normal of triangle
 				
-				dvec3 abn = cross(ab,n); // normal of side ab
+				rvec3 abn = cross(ab,n); // normal of side ab
 				if (dot(abn, ao) > 0)
 				{
 					// origin is outside the triangle at side ab
@@ -158,7 +168,7 @@ public:
 					return false;
 				}
 
-				dvec3 acn = cross(n, ac); // normal of side ac
+				rvec3 acn = cross(n, ac); // normal of side ac
 				if (dot(acn, ao) > 0)
 				{
 					// origin is outside the triangle at side ab
@@ -186,4 +196,168 @@ public:
 		}
 
 	}
+
+	// GJK distance: reduces the simplex to the feature closest to the origin and returns the closest point
+	// supportA is set to the corresponding point on the shape of body a
+	// if the origin is inside the tetrahedron the simplex is kept and (0,0,0) is returned
+	// reference: Ericson, Real-Time Collision Detection, 5.1.5 and 9.5
+	rvec3 ReduceToClosestPoint(rvec3& supportA)
+	{
+		switch(dim)
+		{
+			case 1:
+				supportA = points[0].support;
+				return points[0].p;
+
+			case 2:
+				return closestOnSegment(points[0], points[1], supportA);
+
+			case 3:
+				return closestOnTriangle(points[0], points[1], points[2], supportA);
+
+			case 4:
+			{
+				MinowskiPoint faces[4][4] = {
+					{ points[0], points[1], points[2], points[3] },
+					{ points[0], points[2], points[3], points[1] },
+					{ points[0], points[3], points[1], points[2] },
+					{ points[1], points[3], points[2], points[0] }
+				};
+
+				real minDst = DBL_MAX;
+				rvec3 closest(0);
+				GJKSimplex best = *this;
+
+				for (int i=0; i<4; ++i)
+				{
+					MinowskiPoint& a = faces[i][0];
+					rvec3 n = cross(faces[i][1].p - a.p, faces[i][2].p - a.p);
+
+					// only faces that separate the origin from the opposite vertex
+					if (dot(n, -a.p) * dot(n, faces[i][3].p - a.p) >= 0) continue;
+
+					GJKSimplex face;
+					rvec3 faceSupport;
+					rvec3 p = face.closestOnTriangle(faces[i][0], faces[i][1], faces[i][2], faceSupport);
+
+					if (length2(p) < minDst)
+					{
+						minDst = length2(p);
+						closest = p;
+						supportA = faceSupport;
+						best = face;
+					}
+				}
+
+				// origin is inside the tetrahedron
+				if (minDst == DBL_MAX) return rvec3(0);
+
+				*this = best;
+				return closest;
+			}
+		}
+
+		return rvec3(0);
+	}
+
+private:
+
+	rvec3 closestOnSegment(MinowskiPoint a, MinowskiPoint b, rvec3& supportA)
+	{
+		rvec3 ab = b.p - a.p;
+		real denom = dot(ab, ab);
+		real t = denom > 0 ? -dot(a.p, ab) / denom : 0;
+
+		if (t <= 0)
+		{
+			SetPoints(a);
+			supportA = a.support;
+			return a.p;
+		}
+		if (t >= 1)
+		{
+			SetPoints(b);
+			supportA = b.support;
+			return b.p;
+		}
+
+		SetPoints(a, b);
+		supportA = a.support + t*(b.support - a.support);
+		return a.p + t*ab;
+	}
+
+	// closest point of the triangle abc to the origin (voronoi regions)
+	rvec3 closestOnTriangle(MinowskiPoint a, MinowskiPoint b, MinowskiPoint c, rvec3& supportA)
+	{
+		rvec3 ab = b.p - a.p;
+		rvec3 ac = c.p - a.p;
+
+		// vertex region a
+		real d1 = dot(ab, -a.p);
+		real d2 = dot(ac, -a.p);
+		if (d1 <= 0 && d2 <= 0)
+		{
+			SetPoints(a);
+			supportA = a.support;
+			return a.p;
+		}
+
+		// vertex region b
+		real d3 = dot(ab, -b.p);
+		real d4 = dot(ac, -b.p);
+		if (d3 >= 0 && d4 <= d3)
+		{
+			SetPoints(b);
+			supportA = b.support;
+			return b.p;
+		}
+
+		// edge region ab
+		real vc = d1*d4 - d3*d2;
+		if (vc <= 0 && d1 >= 0 && d3 <= 0)
+		{
+			real v = d1 / (d1 - d3);
+			SetPoints(a, b);
+			supportA = a.support + v*(b.support - a.support);
+			return a.p + v*ab;
+		}
+
+		// vertex region c
+		real d5 = dot(ab, -c.p);
+		real d6 = dot(ac, -c.p);
+		if (d6 >= 0 && d5 <= d6)
+		{
+			SetPoints(c);
+			supportA = c.support;
+			return c.p;
+		}
+
+		// edge region ac
+		real vb = d5*d2 - d1*d6;
+		if (vb <= 0 && d2 >= 0 && d6 <= 0)
+		{
+			real w = d2 / (d2 - d6);
+			SetPoints(a, c);
+			supportA = a.support + w*(c.support - a.support);
+			return a.p + w*ac;
+		}
+
+		// edge region bc
+		real va = d3*d6 - d5*d4;
+		if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0)
+		{
+			real w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+			SetPoints(b, c);
+			supportA = b.support + w*(c.support - b.support);
+			return b.p + w*(c.p - b.p);
+		}
+
+		// face region
+		real denom = 1. / (va + vb + vc);
+		real v = vb * denom;
+		real w = vc * denom;
+		SetPoints(a, b, c);
+		supportA = a.support + v*(b.support - a.support) + w*(c.support - a.support);
+		return a.p + v*ab + w*ac;
+	}
 };
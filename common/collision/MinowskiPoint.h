@@ -2,6 +2,7 @@
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include "Precision.h"
 using namespace glm;
 
 /*
@@ -10,11 +11,11 @@ using namespace glm;
 class MinowskiPoint
 {
 public:
-	dvec3 p;	 // point in minowski space
-	dvec3 support; // original point of the shape of the rigidbody in world coordinates
+	rvec3 p;	 // point in minowski space
+	rvec3 support; // original point of the shape of the rigidbody in world coordinates
 
 	MinowskiPoint() {}
-	MinowskiPoint(dvec3 p, dvec3 support) : p(p), support(support)
+	MinowskiPoint(rvec3 p, rvec3 support) : p(p), support(support)
 	{
 	}
 
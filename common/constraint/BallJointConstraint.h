@@ -12,11 +12,18 @@ public:
 	RigidBody* bodyA;	/// optional TODO: accept none rigidbody two allow single body hinges as in DistanceConstraint
 	RigidBody* bodyB;
 	
-	dvec3 pA_loc;	// local anchor Point of bodyA
-	dvec3 pB_loc;	// local anchor Point of bodyB
+	rvec3 pA_loc;	// local anchor Point of bodyA
+	rvec3 pB_loc;	// local anchor Point of bodyB
 
+private:
+	// cached by Prepare
+	rmat3 J1, J2, J3, J4;
+	rmat3 K_transInv;
+	rvec3 biasTrans;
+
+public:
 	/// p_global: global anchor point of hinge
-	BallJointConstraint(RigidBody* bodyA_In, RigidBody* bodyB_In, dvec3 p_global)
+	BallJointConstraint(RigidBody* bodyA_In, RigidBody* bodyB_In, rvec3 p_global)
 	{
 		this->bodyA = bodyA_In;
 		this->bodyB = bodyB_In;
@@ -28,58 +35,63 @@ public:
 		this->pB_loc = bodyB->GlobalToLocal(p_global);
 		
 	}
+
+	virtual RigidBody* GetBodyA() { return bodyA; }
+	virtual RigidBody* GetBodyB() { return bodyB; }
+
 	// Constraints
 	// C_trans = x2+r2-x1-r1
-	virtual void Solve(double dt)
+	virtual void Prepare(real dt)
 	{
 		// transform local coordinates back to global
 		/// TODO: could be done more efficient with only the rotation matrix	
-		const dvec3 x1 = bodyA->position;
-		const dvec3 x2 = bodyB->position;
-		const dvec3 r1 = bodyA->LocalToGlobal(this->pA_loc)-x1;	/// r1 is from body center to anchor point
-		const dvec3 r2 = bodyB->LocalToGlobal(this->pB_loc)-x2;	/// r2 is from body center to anchor point
+		const rvec3 x1 = bodyA->position;
+		const rvec3 x2 = bodyB->position;
+		const rvec3 r1 = bodyA->LocalToGlobal(this->pA_loc)-x1;	/// r1 is from body center to anchor point
+		const rvec3 r2 = bodyB->LocalToGlobal(this->pB_loc)-x2;	/// r2 is from body center to anchor point
 		
 		// create J_trans:
 		// J = [J1, J2, J3, J4]
-		const dmat3 J1 = -dmat3(1);
-		const dmat3 J2 = GetSkewCrossMatrix(r1);
-		const dmat3 J3 = dmat3(1);
-		const dmat3 J4 = -GetSkewCrossMatrix(r2);
+		J1 = -rmat3(1);
+		J2 = GetSkewCrossMatrix(r1);
+		J3 = rmat3(1);
+		J4 = -GetSkewCrossMatrix(r2);
 		
 		// create mass matrix for translation
-		const dmat3 K_trans = this->bodyA->GetEffectiveMassInverse(J1,J2) + this->bodyB->GetEffectiveMassInverse(J3,J4);
-		
-		// get V
-		// (vA, omegaA, vB, omegaB)
-		const dvec3 v1 = bodyA->velocity;
-		const dvec3 omega1 = bodyA->angularVelocity;
-		const dvec3 v2 = bodyB->velocity;
-		const dvec3 omega2 = bodyB->angularVelocity;
+		const rmat3 K_trans = this->bodyA->GetEffectiveMassInverse(J1,J2) + this->bodyB->GetEffectiveMassInverse(J3,J4);
+		K_transInv = inverse(K_trans);
 		
 		// baumgarte stabilization
-		const double beta = 0.01;
-		const dvec3 C_trans = x2+r2-x1-r1;
-		
-		// --- solve translation constraints ---
-		const dvec3 deltaVTrans = J1*v1 + J2*omega1 + J3*v2 + J4*omega2 + beta/dt*C_trans;
-		const dvec3 lambdaTrans = -inverse(K_trans)*deltaVTrans;
+		const real beta = 0.01;
+		const rvec3 C_trans = x2+r2-x1-r1;
+		biasTrans = beta/dt*C_trans;
+	}
 
-		const dvec3 impulseLinear1 = J1*lambdaTrans;
-		const dvec3 impulseAngular1 = -J2*lambdaTrans;	/// thomaset: why the heck has a minus to be here? Only works like this...
-		const dvec3 impulseLinear2 = J3*lambdaTrans;
-		const dvec3 impulseAngular2 = -J4*lambdaTrans;	/// thomaset: why the heck has a minus to be here? Only works like this...
-		
-		// --- Apply the impulses --	
-		bodyA->ApplyLinearMomentum(impulseLinear1);
-		bodyA->ApplyAngularMomentum(impulseAngular1);
-		
-		bodyB->ApplyLinearMomentum(impulseLinear2);
-		bodyB->ApplyAngularMomentum(impulseAngular2);
+	virtual void Solve(real dt)
+	{
+		solve(true);
+	}
+
+	// iteration after the positions were integrated (temporal gauss seidel): prepared jacobians, no baumgarte bias
+	virtual void Relax(real dt)
+	{
+		solve(false);
+	}
+
+	// XPBD: moves the two anchor points onto each other
+	virtual void Project(real h)
+	{
+		const rvec3 pA = bodyA->LocalToGlobal(this->pA_loc);
+		const rvec3 pB = bodyB->LocalToGlobal(this->pB_loc);
+		const real C = length(pB - pA);
+		if (C < 1e-12) return;
+
+		appliedImpulse = std::abs(projectPositional(bodyA, pA - bodyA->position, bodyB, pB - bodyB->position, (pB - pA)/C, C, h));
 	}
 		
 	// https://en.wikipedia.org/wiki/Skew-symmetric_matrix#Cross_product
-	dmat3 GetSkewCrossMatrix(const dvec3 v1) const{
-		dmat3 result(0);
+	rmat3 GetSkewCrossMatrix(const rvec3 v1) const{
+		rmat3 result(0);
 		result[1][0] = -v1[2];
 		result[2][0] = v1[1];
 		
@@ -90,4 +102,33 @@ public:
 		result[1][2] = v1[0];
 		return result;
 	}
+
+private:
+
+	void solve(bool bias)
+	{
+		// get V
+		// (vA, omegaA, vB, omegaB)
+		const rvec3 v1 = bodyA->velocity;
+		const rvec3 omega1 = bodyA->angularVelocity;
+		const rvec3 v2 = bodyB->velocity;
+		const rvec3 omega2 = bodyB->angularVelocity;
+		
+		// --- solve translation constraints ---
+		const rvec3 deltaVTrans = J1*v1 + J2*omega1 + J3*v2 + J4*omega2 + (bias ? biasTrans : rvec3(0));
+		const rvec3 lambdaTrans = -K_transInv*deltaVTrans;
+
+		const rvec3 impulseLinear1 = J1*lambdaTrans;
+		const rvec3 impulseAngular1 = -J2*lambdaTrans;	/// thomaset: why the heck has a minus to be here? Only works like this...
+		const rvec3 impulseLinear2 = J3*lambdaTrans;
+		const rvec3 impulseAngular2 = -J4*lambdaTrans;	/// thomaset: why the heck has a minus to be here? Only works like this...
+		appliedImpulse = length(lambdaTrans);
+		
+		// --- Apply the impulses --	
+		bodyA->ApplyLinearMomentum(impulseLinear1);
+		bodyA->ApplyAngularMomentum(impulseAngular1);
+		
+		bodyB->ApplyLinearMomentum(impulseLinear2);
+		bodyB->ApplyAngularMomentum(impulseAngular2);
+	}
 };
@@ -13,8 +13,15 @@ public:
 
 	RigidBody* bodyA;
 	RigidBody* bodyB;
-	double L;
+	real L;
 
+private:
+	// cached by Prepare
+	rvec3 dir;
+	real b;
+	real effectiveMass;
+
+public:
 	BodyDistanceConstraint(RigidBody* bodyA, RigidBody* bodyB)
 	{
 		this->bodyA = bodyA;
@@ -22,33 +29,62 @@ public:
 		this->L = length(bodyB->position - bodyA->position); // save initial distance
 	}
 
-	virtual void Solve(double dt)
-	{
-		dvec3 dst = bodyB->position - bodyA->position;
+	virtual RigidBody* GetBodyA() { return bodyA; }
+	virtual RigidBody* GetBodyB() { return bodyB; }
 
-		// get V
-		// (vA, vB)
-		dvec3 vA = bodyA->velocity;
-		dvec3 vB = bodyB->velocity;
+	virtual void Prepare(real dt)
+	{
+		rvec3 dst = bodyB->position - bodyA->position;
 
 		// create J:
 		// (dir,  -dir)
-		dvec3 dir = normalize(dst);
+		dir = normalize(dst);
 
 		// b to correct the distance
-		double b = -length(dst) + L;	/// TODO: thomaset: why the minus??? shouldn't it be b = lentgth(x) - L ?? baumgarte stabilization adds beta/dt * C
+		b = -length(dst) + L;	/// TODO: thomaset: why the minus??? shouldn't it be b = lentgth(x) - L ?? baumgarte stabilization adds beta/dt * C
 
 		// create effectiveMass = 1/(transpose(J)*MInverse*J)
-		double effectiveMass = 1./(bodyA->inverseMass + bodyB->inverseMass);
+		effectiveMass = 1./(bodyA->inverseMass + bodyB->inverseMass);
+	}
+
+	virtual void Solve(real dt)
+	{
+		solve(true);
+	}
+
+	// iteration after the positions were integrated (temporal gauss seidel): prepared jacobians, no baumgarte bias
+	virtual void Relax(real dt)
+	{
+		solve(false);
+	}
+
+	// XPBD: moves the centers along their connection until the distance is L
+	virtual void Project(real h)
+	{
+		const rvec3 d = bodyB->position - bodyA->position;
+		const real distance = length(d);
+		if (distance < 1e-12) return;
+
+		appliedImpulse = std::abs(projectPositional(bodyA, rvec3(0), bodyB, rvec3(0), d/distance, distance - L, h));
+	}
+
+private:
+
+	void solve(bool bias)
+	{
+		// get V
+		// (vA, vB)
+		rvec3 vA = bodyA->velocity;
+		rvec3 vB = bodyB->velocity;
 
 		// solve (dot(J,V)+b)
-		double deltaV = dot(vA, dir) - dot(vB, dir) + b;
-		double lambda = -effectiveMass * deltaV;
+		real deltaV = dot(vA, dir) - dot(vB, dir) + (bias ? b : 0);
+		real lambda = -effectiveMass * deltaV;
+		appliedImpulse = std::abs(lambda);
 
-		dvec3 force = dir*lambda;
+		rvec3 force = dir*lambda;
 
 		bodyA->ApplyLinearMomentum(force);
 		bodyB->ApplyLinearMomentum(-force);
 	}
-
 };
@@ -15,24 +15,106 @@ class Constraint
 {
 
 public:
-	virtual void Solve(double dt) {}
-	virtual void Apply(double dt) {}
+	real appliedImpulse = 0; // magnitude of the impulse applied by the last Solve (measure of convergence)
+
+	virtual ~Constraint() {}
+
+	// computes everything that stays constant during the iterations of one (sub)step (anchors, jacobians, effective masses)
+	virtual void Prepare(real dt) {}
+	virtual void Solve(real dt) {}
+	virtual void Apply(real dt) {}
+
+	// iteration without position correction bias (temporal gauss seidel), defaults to a normal iteration
+	virtual void Relax(real dt) { Solve(dt); }
+
+	// position based dynamics (XPBD): corrects the position error directly, called once per substep
+	virtual void Project(real h) {}
+
+	// bodies connected by the constraint, used to find independent islands (NULL if not connected to a body)
+	virtual RigidBody* GetBodyA() { return NULL; }
+	virtual RigidBody* GetBodyB() { return NULL; }
 
 protected:
-	double addAndClampSum(double &sum, double lambda)
+	// the sums are accumulated in the accum type (see Precision.h), the returned change is applied in real
+	real addAndClampSum(accum &sum, real lambda)
 	{
-		double oldSum = sum;
+		accum oldSum = sum;
 		sum += lambda;
 		if (sum < 0) sum = 0; 
 		return sum - oldSum;
 	}
 	
-	double addAndClampSum(double &sum, double lambda, double lowerBound, double upperBound)
+	real addAndClampSum(accum &sum, real lambda, accum lowerBound, accum upperBound)
 	{
-		double oldSum = sum;
+		accum oldSum = sum;
 		sum += lambda;
 		if (sum < lowerBound) sum = lowerBound; 
 		if (sum > upperBound) sum = upperBound; 
 		return sum - oldSum;
 	}
+
+	// XPBD positional correction: moves the point rA (relative to the center) of A by +n and rB of B by -n
+	// until the violation c along n is corrected, b may be NULL (fixed point)
+	// compliance = inverse stiffness (0 is rigid), damping acts on the motion since the beginning of the substep
+	// reference: https://matthias-research.github.io/pages/publications/PBDBodies.pdf (section 3.3.1)
+	// returns the positional impulse (lambda)
+	static real projectPositional(RigidBody* a, rvec3 rA, RigidBody* b, rvec3 rB, rvec3 n, real c, real h, real compliance = 0, real damping = 0)
+	{
+		real w = a->GetEffectiveMassInverse(n, cross(rA, n));
+		real motion = dot(n, a->position - a->previousPosition);
+		if (b != NULL)
+		{
+			w += b->GetEffectiveMassInverse(n, cross(rB, n));
+			motion -= dot(n, b->position - b->previousPosition);
+		}
+
+		const real alpha = compliance / (h*h);
+		const real gamma = compliance * damping / h;
+		const real d = (1 + gamma) * w + alpha;
+		if (d <= 0) return 0;
+
+		real lambda = (c - gamma*motion) / d;
+		rvec3 p = n * lambda;
+		a->ApplyPositionCorrection(p, cross(rA, p));
+		if (b != NULL) b->ApplyPositionCorrection(-p, -cross(rB, p));
+		return lambda;
+	}
+
+	// XPBD angular correction: rotates A by the angle |rotation| around the axis of rotation (B in the opposite direction)
+	static real projectAngular(RigidBody* a, RigidBody* b, rvec3 rotation, real h, real compliance = 0)
+	{
+		real angle = length(rotation);
+		if (angle < 1e-12) return 0;
+		rvec3 n = rotation / angle;
+
+		real w = dot(n, a->inertiaTensorInverse * n);
+		if (b != NULL) w += dot(n, b->inertiaTensorInverse * n);
+
+		const real d = w + compliance / (h*h);
+		if (d <= 0) return 0;
+
+		real lambda = angle / d;
+		a->ApplyPositionCorrection(rvec3(0), n * lambda);
+		if (b != NULL) b->ApplyPositionCorrection(rvec3(0), -n * lambda);
+		return lambda;
+	}
+
+	// implicit (backward euler) spring and damper as soft constraint, stable for any stiffness
+	// gamma: softness added to the inverse effective mass, beta: fraction of the position error corrected per step
+	// (CFM = gamma*dt and ERP = beta in http://www.ode.org/ode-latest-userguide.html#sec_3_8_0)
+	// reference: http://box2d.org/files/GDC2011/GDC2011_Catto_Erin_Soft_Constraints.pdf
+	// returns false if the constraint has neither stiffness nor damping
+	static bool softParameters(real stiffness, real damping, real dt, real& gamma, real& beta)
+	{
+		const real d = damping + dt*stiffness;
+		if (d <= 0)
+		{
+			gamma = 0;
+			beta = 0;
+			return false;
+		}
+		gamma = 1./(dt*d);
+		beta = dt*stiffness/d;
+		return true;
+	}
 };
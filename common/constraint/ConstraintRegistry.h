@@ -0,0 +1,111 @@
+#pragma once
+
+#include <vector>
+#include <type_traits>
+
+#include "constraint/Constraint.h"
+#include "constraint/HingeConstraint.h"
+#include "constraint/BallJointConstraint.h"
+#include "constraint/DistanceConstraint.h"
+#include "constraint/SoftDistanceConstraint.h"
+#include "constraint/SpringConstraint.h"
+#include "constraint/BodyDistanceConstraint.h"
+#include "constraint/TwoBodyDistanceConstraint.h"
+#include "constraint/SoftTwoBodyDistanceConstraint.h"
+
+// handle of a constraint stored in the registry, stays valid until the registry is cleared
+template<typename T>
+struct ConstraintHandle
+{
+	int index;
+
+	ConstraintHandle(int i = -1) : index(i) {}
+	bool IsValid() const { return index >= 0; }
+};
+
+// constraint types that have their own array in the registry
+template<typename T> struct IsRegisteredConstraint : std::false_type {};
+template<> struct IsRegisteredConstraint<HingeConstraint> : std::true_type {};
+template<> struct IsRegisteredConstraint<BallJointConstraint> : std::true_type {};
+template<> struct IsRegisteredConstraint<DistanceConstraint> : std::true_type {};
+template<> struct IsRegisteredConstraint<SoftDistanceConstraint> : std::true_type {};
+template<> struct IsRegisteredConstraint<SpringConstraint> : std::true_type {};
+template<> struct IsRegisteredConstraint<BodyDistanceConstraint> : std::true_type {};
+template<> struct IsRegisteredConstraint<TwoBodyDistanceConstraint> : std::true_type {};
+template<> struct IsRegisteredConstraint<SoftTwoBodyDistanceConstraint> : std::true_type {};
+
+/*
+ * Stores the persistent constraints by value, every type in its own contiguous array,
+ * so the solver can loop over them with statically dispatched kernels instead of virtual calls
+ */
+class ConstraintRegistry
+{
+
+public:
+	static const int NumberOfTypes = 8;
+
+	template<typename T>
+	ConstraintHandle<T> Add(const T& c)
+	{
+		std::vector<T>& a = arrayOf((T*)0);
+		a.push_back(c);
+		return ConstraintHandle<T>((int)a.size()-1);
+	}
+
+	template<typename T>
+	T& Get(ConstraintHandle<T> h)
+	{
+		return arrayOf((T*)0)[h.index];
+	}
+
+	// calls f(array, typeIndex) for the array of every type, f needs a templated operator()
+	template<typename F>
+	void ForEachArray(F& f)
+	{
+		f(hinges, 0);
+		f(ballJoints, 1);
+		f(distances, 2);
+		f(softDistances, 3);
+		f(springs, 4);
+		f(bodyDistances, 5);
+		f(twoBodyDistances, 6);
+		f(softTwoBodyDistances, 7);
+	}
+
+	int Size()
+	{
+		return (int)(hinges.size() + ballJoints.size() + distances.size() + softDistances.size() +
+			springs.size() + bodyDistances.size() + twoBodyDistances.size() + softTwoBodyDistances.size());
+	}
+
+	void Clear()
+	{
+		hinges.clear();
+		ballJoints.clear();
+		distances.clear();
+		softDistances.clear();
+		springs.clear();
+		bodyDistances.clear();
+		twoBodyDistances.clear();
+		softTwoBodyDistances.clear();
+	}
+
+private:
+	std::vector<HingeConstraint> hinges;
+	std::vector<BallJointConstraint> ballJoints;
+	std::vector<DistanceConstraint> distances;
+	std::vector<SoftDistanceConstraint> softDistances;
+	std::vector<SpringConstraint> springs;
+	std::vector<BodyDistanceConstraint> bodyDistances;
+	std::vector<TwoBodyDistanceConstraint> twoBodyDistances;
+	std::vector<SoftTwoBodyDistanceConstraint> softTwoBodyDistances;
+
+	std::vector<HingeConstraint>& arrayOf(HingeConstraint*) { return hinges; }
+	std::vector<BallJointConstraint>& arrayOf(BallJointConstraint*) { return ballJoints; }
+	std::vector<DistanceConstraint>& arrayOf(DistanceConstraint*) { return distances; }
+	std::vector<SoftDistanceConstraint>& arrayOf(SoftDistanceConstraint*) { return softDistances; }
+	std::vector<SpringConstraint>& arrayOf(SpringConstraint*) { return springs; }
+	std::vector<BodyDistanceConstraint>& arrayOf(BodyDistanceConstraint*) { return bodyDistances; }
+	std::vector<TwoBodyDistanceConstraint>& arrayOf(TwoBodyDistanceConstraint*) { return twoBodyDistances; }
+	std::vector<SoftTwoBodyDistanceConstraint>& arrayOf(SoftTwoBodyDistanceConstraint*) { return softTwoBodyDistances; }
+};
@@ -7,8 +7,23 @@ using namespace glm;
 
 #include "Constraint.h"
 #include "ContactConstraint.h"
+#include "ContactManifoldConstraint.h"
+#include "ConstraintRegistry.h"
 
 #include <vector>
+#include <algorithm>
+#include <climits>
+
+#define SOLVER_TOLERANCE 1e-3 // an island is converged when no constraint applies more impulse than this in one iteration
+#define SOLVER_MIN_ITERATIONS 1
+
+enum ConstraintSolverType
+{
+	ProjectedGaussSeidel, // sequential impulses
+	// still sequential gauss seidel sweeps (no jacobi sweeps, not parallel), the contact impulses are accelerated
+	// along conjugate directions after each sweep (NNCG)
+	ConjugateGaussSeidel
+};
 
 
 /* 
@@ -20,15 +35,77 @@ class ConstraintSolver
 {
 
 private:
-	int iterations = 4;
+	int iterations = 4; // max iterations per island
+	int minIterations = SOLVER_MIN_ITERATIONS;
+	real tolerance = SOLVER_TOLERANCE;
+	bool splitImpulse = false;
+	bool blockSolver = false; // solve the normal impulses of a manifold together
+	ConstraintSolverType solverType = ProjectedGaussSeidel;
+	bool shockPropagation = false; // final sweep bottom up, the lower bodies of a contact are treated as static
+	bool deterministic = false; // contacts in the order of the body ids instead of the (history dependent) hash map order
+
+	ConstraintRegistry registry; // persistent constraints sorted by type
+	std::vector<Constraint*> persistantConstraints; // constraint types unknown to the registry
+
+	std::vector<ContactConstraint*> dynamicConstraints; // all contacts (warm start, position correction)
+	std::vector<ContactConstraint*> contactConstraints; // contacts solved on their own
+	std::vector<ContactManifoldConstraint*> manifoldConstraints; // manifolds solved with the block solver
+	std::vector<std::pair<std::pair<int,int>, ContactManifold*>> orderedManifolds; // active manifolds in solving order
+
+	// independent groups of bodies connected by constraints, static bodies do not connect islands
+	struct Island
+	{
+		std::vector<ContactConstraint*> contacts;
+		std::vector<ContactManifoldConstraint*> manifolds;
+		std::vector<int> joints[ConstraintRegistry::NumberOfTypes]; // indices into the arrays of the registry
+		std::vector<Constraint*> others;
+		int iterations;
+		real residual; // largest impulse of one constraint in the last iteration
+
+		void Clear()
+		{
+			contacts.clear();
+			manifolds.clear();
+			for (std::vector<int>& j : joints) j.clear();
+			others.clear();
+		}
+	};
+	std::vector<Island> islands; // reused between steps, only the first islandCount are valid
+	int islandCount = 0;
+	std::vector<int> islandParent; // union find over the islandNode of the bodies
+	std::vector<int> islandOfRoot;
+	std::vector<RigidBody*> islandBodies;
+
+	// contacts and manifolds sorted bottom up for the shock propagation sweep
+	struct ShockEntry
+	{
+		int level;
+		Constraint* constraint;
 
-	std::vector<Constraint*> persistantConstraints;
-	std::vector<Constraint*> dynamicConstraints;
+		bool operator<(const ShockEntry& o) const { return level < o.level; }
+	};
+	std::vector<ShockEntry> shockOrder;
+
+	// statistics of the last Solve
+	int usedIterations = 0; // max over all islands
+	real residual = 0; // largest impulse of one constraint in the last iteration, max over all islands
 
 public:
 
 	void SetIterations(int i) { this->iterations = i; }
 	int GetIterations() { return this->iterations; }
+	void SetMinIterations(int i) { this->minIterations = i; }
+	void SetTolerance(real t) { this->tolerance = t; }
+	void SetSplitImpulse(bool enabled) { this->splitImpulse = enabled; }
+	void SetBlockSolver(bool enabled) { this->blockSolver = enabled; }
+	void SetSolverType(ConstraintSolverType t) { this->solverType = t; }
+	void SetShockPropagation(bool enabled) { this->shockPropagation = enabled; }
+	void SetDeterministic(bool enabled) { this->deterministic = enabled; }
+	ConstraintSolverType GetSolverType() { return this->solverType; }
+
+	int GetUsedIterations() { return usedIterations; }
+	real GetResidual() { return residual; }
+	int GetIslandCount() { return islandCount; }
 
 	ConstraintSolver()
 	{
@@ -40,13 +117,32 @@ public:
 		Clear();
 	}
 
+	// known constraint types are copied into the registry, use the handle to access them later
+	template<typename T>
+	typename std::enable_if<IsRegisteredConstraint<T>::value, ConstraintHandle<T>>::type AddConstraint(const T& c)
+	{
+		return registry.Add(c);
+	}
+
+	// known constraint types are only added by value (a pointer would otherwise be taken as an unregistered constraint)
+	template<typename T>
+	typename std::enable_if<IsRegisteredConstraint<T>::value>::type AddConstraint(T* c) = delete;
+
+	// other constraints are solved via the virtual interface, the solver takes the ownership
 	void AddConstraint(Constraint* c)
 	{
 		this->persistantConstraints.push_back(c);
 	}
 
+	template<typename T>
+	T& GetConstraint(ConstraintHandle<T> handle)
+	{
+		return registry.Get(handle);
+	}
+
 	void Clear()
 	{
+		registry.Clear();
 		for (Constraint* c : persistantConstraints)
 		{
 			delete c;
@@ -55,48 +151,530 @@ public:
 	}
 
 
-	void Solve(double dt, std::unordered_map<std::pair<int,int>, ContactManifold*>& activeContactManifolds)
+	void Solve(real dt, std::unordered_map<std::pair<int,int>, ContactManifold*>& activeContactManifolds)
 	{
 		// create constraints
-		dynamicConstraints.clear();
+		collectContactConstraints(activeContactManifolds);
+		prepare(dt);
+
+		// warm start
+		warmStart(dt);
+
+		buildIslands();
+
+		// every island iterates until the impulses have converged or its budget is used up
+		usedIterations = 0;
+		residual = 0;
+		for (int i=0; i<islandCount; ++i)
+		{
+			Island& island = islands[i];
+			island.iterations = 0;
+			real impulseChange = 0;
+			do
+			{
+				island.iterations++;
+				if (solverType == ConjugateGaussSeidel) storeImpulses(island);
+				island.residual = solveIsland(island, dt);
+				if (solverType == ConjugateGaussSeidel) impulseChange = conjugateStep(island, impulseChange);
+			}
+			while (island.iterations < iterations && (island.iterations < minIterations || island.residual > tolerance));
+
+			residual = std::max(residual, island.residual);
+			usedIterations = std::max(usedIterations, island.iterations);
+		}
+
+		if (shockPropagation) propagateShock(dt);
+
+		if (splitImpulse) solvePositions(dt, iterations);
+	}
+
+	// temporal gauss seidel: one iteration per substep, the contacts are not recomputed but moved with the bodies
+	// reference: https://box2d.org/posts/2024/02/solver2d/ (soft step / TGS)
+	void SolveSubstep(real dt, std::unordered_map<std::pair<int,int>, ContactManifold*>& activeContactManifolds)
+	{
+		collectContactConstraints(activeContactManifolds);
+		updateSeparations();
+		prepare(dt);
+
+		warmStart(dt);
+
+		solveAll(SolveKernel(), dt);
+
+		if (splitImpulse) solvePositions(dt, 1);
+	}
+
+	// relaxation after the positions of the substep were integrated (uses the constraints and prepared jacobians of the last SolveSubstep)
+	void Relax(real dt)
+	{
+		updateSeparations();
+
+		solveAll(RelaxKernel(), dt);
+	}
+
+	// position based dynamics (XPBD): one position iteration per substep, the contacts are moved with the bodies during the iteration
+	// reference: https://matthias-research.github.io/pages/publications/PBDBodies.pdf
+	void Project(real h, std::unordered_map<std::pair<int,int>, ContactManifold*>& activeContactManifolds)
+	{
+		collectContactConstraints(activeContactManifolds);
+
+		// the block solver has no position level variant, all contacts are projected on their own
+		for (ContactConstraint* c : dynamicConstraints) c->ContactConstraint::Project(h);
+
+		ArrayLoop<ProjectKernel> loop = { ProjectKernel(), h };
+		registry.ForEachArray(loop);
+
+		for (Constraint* c : persistantConstraints) c->Project(h);
+	}
+
+	int CountPersistentConstraints() { return registry.Size() + (int)persistantConstraints.size(); }
 
-		for (std::pair<const std::pair<int,int>, ContactManifold*>& i : activeContactManifolds)
+	// impulses of the persistent constraints for the snapshots (registry by type, then the others)
+	void SaveImpulses(std::vector<real>& impulses)
+	{
+		ImpulseCopy copy = { &impulses, 0, true };
+		registry.ForEachArray(copy);
+		for (Constraint* c : persistantConstraints) impulses.push_back(c->appliedImpulse);
+	}
+
+	// the constraints must be the same as when the impulses were saved
+	void RestoreImpulses(const std::vector<real>& impulses)
+	{
+		ImpulseCopy copy = { const_cast<std::vector<real>*>(&impulses), 0, false };
+		registry.ForEachArray(copy);
+		for (Constraint* c : persistantConstraints) c->appliedImpulse = impulses[copy.next++];
+	}
+
+	// XPBD velocity pass after the velocities were derived from the positions (dynamic friction, restitution)
+	void SolveVelocities(real h)
+	{
+		for (ContactConstraint* c : dynamicConstraints) c->SolveVelocity(h);
+	}
+
+private:
+
+	// statically dispatched kernels (T::Solve instead of the virtual call)
+	struct SolveKernel
+	{
+		template<typename T>
+		void operator()(T& c, real dt) { c.T::Solve(dt); }
+		void operator()(Constraint& c, real dt) { c.Solve(dt); } // types unknown to the registry
+	};
+	struct RelaxKernel
+	{
+		template<typename T>
+		void operator()(T& c, real dt) { c.T::Relax(dt); }
+		void operator()(Constraint& c, real dt) { c.Relax(dt); } // types unknown to the registry
+	};
+	struct ProjectKernel
+	{
+		template<typename T>
+		void operator()(T& c, real h) { c.T::Project(h); }
+		void operator()(Constraint& c, real h) { c.Project(h); } // types unknown to the registry
+	};
+	struct PrepareKernel
+	{
+		template<typename T>
+		void operator()(T& c, real dt) { c.T::Prepare(dt); }
+		void operator()(Constraint& c, real dt) { c.Prepare(dt); } // types unknown to the registry
+	};
+	struct ApplyKernel
+	{
+		template<typename T>
+		void operator()(T& c, real dt) { c.T::Apply(dt); }
+		void operator()(Constraint& c, real dt) { c.Apply(dt); } // types unknown to the registry
+	};
+
+	// runs a kernel over a whole registry array
+	template<typename K>
+	struct ArrayLoop
+	{
+		K kernel;
+		real dt;
+
+		template<typename T>
+		void operator()(std::vector<T>& a, int type)
+		{
+			for (T& c : a) kernel(c, dt);
+		}
+	};
+
+	// one iteration over the joints of an island, keeps the largest applied impulse
+	struct IslandLoop
+	{
+		Island* island;
+		real dt;
+		real maxImpulse;
+
+		template<typename T>
+		void operator()(std::vector<T>& a, int type)
+		{
+			for (int i : island->joints[type])
+			{
+				T& c = a[i];
+				c.T::Solve(dt);
+				maxImpulse = std::max(maxImpulse, c.appliedImpulse);
+			}
+		}
+	};
+
+	// copies the impulses of the registry arrays from/to a flat array
+	struct ImpulseCopy
+	{
+		std::vector<real>* impulses;
+		int next;
+		bool save;
+
+		template<typename T>
+		void operator()(std::vector<T>& a, int type)
 		{
-			for (Contact* c : i.second->contacts)
+			for (T& c : a)
 			{
-				if (c->bodyA->inactive && c->bodyB->inactive) continue;
-				else if (c->bodyA->inactive && c->bodyB->isStatic) continue;
-				else if (c->bodyA->isStatic && c->bodyB->inactive) continue;
+				if (save) impulses->push_back(c.appliedImpulse);
+				else c.appliedImpulse = (*impulses)[next++];
+			}
+		}
+	};
+
+	// passes of the island search over the registry arrays
+	struct IslandSearch
+	{
+		ConstraintSolver* solver;
+		int pass; // 0: create nodes, 1: union, 2: assign to islands
+
+		template<typename T>
+		void operator()(std::vector<T>& a, int type)
+		{
+			for (int i=0; i<(int)a.size(); ++i)
+			{
+				RigidBody* bodyA = a[i].T::GetBodyA();
+				RigidBody* bodyB = a[i].T::GetBodyB();
+				if (pass == 0) solver->addIslandNodes(bodyA, bodyB);
+				else if (pass == 1) solver->unionIslands(bodyA, bodyB);
+				else solver->islandOf(bodyA, bodyB).joints[type].push_back(i);
+			}
+		}
+	};
+
+	// runs a kernel over all constraints (contacts, manifolds, registry, others)
+	template<typename K>
+	void solveAll(K kernel, real dt)
+	{
+		for (ContactConstraint* c : contactConstraints) kernel(*c, dt);
+		for (ContactManifoldConstraint* c : manifoldConstraints) kernel(*c, dt);
+
+		ArrayLoop<K> loop = { kernel, dt };
+		registry.ForEachArray(loop);
+
+		for (Constraint* c : persistantConstraints) kernel(*c, dt);
+	}
+
+	// one iteration, returns the largest impulse applied by a single constraint (independent of the size of the island)
+	real solveIsland(Island& island, real dt)
+	{
+		real maxImpulse = 0;
+		for (ContactConstraint* c : island.contacts)
+		{
+			c->ContactConstraint::Solve(dt);
+			maxImpulse = std::max(maxImpulse, c->appliedImpulse);
+		}
+		for (ContactManifoldConstraint* c : island.manifolds)
+		{
+			c->ContactManifoldConstraint::Solve(dt);
+			maxImpulse = std::max(maxImpulse, c->appliedImpulse);
+		}
+
+		IslandLoop loop = { &island, dt, 0 };
+		registry.ForEachArray(loop);
+		maxImpulse = std::max(maxImpulse, loop.maxImpulse);
 
+		for (Constraint* c : island.others)
+		{
+			c->Solve(dt);
+			maxImpulse = std::max(maxImpulse, c->appliedImpulse);
+		}
+		return maxImpulse;
+	}
+
+	void storeImpulses(Island& island)
+	{
+		for (ContactConstraint* c : island.contacts) c->StoreImpulses();
+		for (ContactManifoldConstraint* m : island.manifolds)
+		{
+			for (Contact* c : m->manifold->contacts) c->constraint->StoreImpulses();
+		}
+	}
+
+	// NNCG step after a gauss seidel sweep, the joints are not accelerated
+	// beta is the ratio of the squared impulse changes of the last two sweeps, restart if it grows
+	// reference: Silcowitz et al., A nonsmooth nonlinear conjugate gradient method for interactive contact force problems
+	real conjugateStep(Island& island, real lastImpulseChange)
+	{
+		real impulseChange = 0;
+		for (ContactConstraint* c : island.contacts) impulseChange += length2(c->ImpulseChange());
+		for (ContactManifoldConstraint* m : island.manifolds)
+		{
+			for (Contact* c : m->manifold->contacts) impulseChange += length2(c->constraint->ImpulseChange());
+		}
+
+		real beta = 0;
+		if (lastImpulseChange > 0 && impulseChange < lastImpulseChange) beta = impulseChange / lastImpulseChange;
+
+		for (ContactConstraint* c : island.contacts) c->ApplyConjugateStep(beta);
+		for (ContactManifoldConstraint* m : island.manifolds)
+		{
+			for (Contact* c : m->manifold->contacts) c->constraint->ApplyConjugateStep(beta);
+		}
+		return impulseChange;
+	}
+
+	void collectContactConstraints(std::unordered_map<std::pair<int,int>, ContactManifold*>& activeContactManifolds)
+	{
+		dynamicConstraints.clear();
+		contactConstraints.clear();
+		manifoldConstraints.clear();
+
+		orderedManifolds.assign(activeContactManifolds.begin(), activeContactManifolds.end());
+
+		// the keys (pairs of body ids) are unique, the order of the constraints and thus of the islands only depends on the ids
+		if (deterministic) std::sort(orderedManifolds.begin(), orderedManifolds.end());
+
+		for (std::pair<std::pair<int,int>, ContactManifold*>& i : orderedManifolds)
+		{
+			ContactManifold* m = i.second;
+			if (m->contacts.empty()) continue;
+
+			// all contacts of a manifold belong to the same pair of bodies
+			RigidBody* a = m->contacts.front()->bodyA;
+			RigidBody* b = m->contacts.front()->bodyB;
+			if (a->inactive && b->inactive) continue;
+			else if (a->inactive && b->isStatic) continue;
+			else if (a->isStatic && b->inactive) continue;
+
+			bool block = blockSolver && m->contacts.size() > 1;
+
+			for (Contact* c : m->contacts)
+			{
+				c->constraint->splitImpulse = splitImpulse;
 				dynamicConstraints.push_back(c->constraint);
+				if (!block) contactConstraints.push_back(c->constraint);
 			}
+
+			if (block) manifoldConstraints.push_back(m->constraint);
 		}
+	}
 
-		// warm start
-		for (Constraint* c : dynamicConstraints)
+	// groups the constraints by connected bodies, within an island they are sorted by type (contacts first)
+	void buildIslands()
+	{
+		islandBodies.clear();
+		islandParent.clear();
+
+		// assign union find nodes to the dynamic bodies
+		IslandSearch search = { this, 0 };
+		for (ContactConstraint* c : contactConstraints) addIslandNodes(c->GetBodyA(), c->GetBodyB());
+		for (ContactManifoldConstraint* c : manifoldConstraints) addIslandNodes(c->GetBodyA(), c->GetBodyB());
+		registry.ForEachArray(search);
+		for (Constraint* c : persistantConstraints) addIslandNodes(c->GetBodyA(), c->GetBodyB());
+
+		// connect them
+		search.pass = 1;
+		for (ContactConstraint* c : contactConstraints) unionIslands(c->GetBodyA(), c->GetBodyB());
+		for (ContactManifoldConstraint* c : manifoldConstraints) unionIslands(c->GetBodyA(), c->GetBodyB());
+		registry.ForEachArray(search);
+		for (Constraint* c : persistantConstraints) unionIslands(c->GetBodyA(), c->GetBodyB());
+
+		// map the roots to islands
+		islandOfRoot.assign(islandParent.size() + 1, -1); // last entry: constraints without a dynamic body
+		islandCount = 0;
+		search.pass = 2;
+		for (ContactConstraint* c : contactConstraints) islandOf(c->GetBodyA(), c->GetBodyB()).contacts.push_back(c);
+		for (ContactManifoldConstraint* c : manifoldConstraints) islandOf(c->GetBodyA(), c->GetBodyB()).manifolds.push_back(c);
+		registry.ForEachArray(search);
+		for (Constraint* c : persistantConstraints) islandOf(c->GetBodyA(), c->GetBodyB()).others.push_back(c);
+
+		for (RigidBody* b : islandBodies)
 		{
-			c->Apply(dt);
+			b->islandNode = -1;
 		}
-		for (Constraint* c : persistantConstraints)
+	}
+
+	void addIslandNodes(RigidBody* a, RigidBody* b)
+	{
+		addIslandNode(a);
+		addIslandNode(b);
+	}
+
+	void addIslandNode(RigidBody* b)
+	{
+		if (b == NULL || b->isStatic || b->islandNode >= 0) return;
+		b->islandNode = (int)islandParent.size();
+		islandParent.push_back(b->islandNode);
+		islandBodies.push_back(b);
+	}
+
+	void unionIslands(RigidBody* a, RigidBody* b)
+	{
+		int nodeA = islandNodeOf(a);
+		int nodeB = islandNodeOf(b);
+		if (nodeA >= 0 && nodeB >= 0) islandParent[findIsland(nodeA)] = findIsland(nodeB);
+	}
+
+	Island& islandOf(RigidBody* a, RigidBody* b)
+	{
+		int node = islandNodeOf(a);
+		if (node < 0) node = islandNodeOf(b);
+
+		int& index = node >= 0 ? islandOfRoot[findIsland(node)] : islandOfRoot.back();
+		if (index < 0)
+		{
+			index = islandCount++;
+			if (index == (int)islands.size()) islands.push_back(Island());
+			else islands[index].Clear();
+		}
+		return islands[index];
+	}
+
+	int islandNodeOf(RigidBody* b)
+	{
+		return b == NULL ? -1 : b->islandNode;
+	}
+
+	int findIsland(int node)
+	{
+		while (islandParent[node] != node)
+		{
+			islandParent[node] = islandParent[islandParent[node]]; // path halving
+			node = islandParent[node];
+		}
+		return node;
+	}
+
+	// shock propagation: one more sweep over the contacts ordered from the ground upwards, in which the lower
+	// body of every contact is treated as static, thus the upper layers can not push the lower ones into the ground
+	// reference: Guendelman et al., Nonconvex rigid bodies with stacking (2003), section 7
+	void propagateShock(real dt)
+	{
+		shockOrder.clear();
+		for (ContactConstraint* c : contactConstraints) addShockEntry(c);
+		for (ContactManifoldConstraint* c : manifoldConstraints) addShockEntry(c);
+
+		// breadth first search from the static bodies over the contacts, one level per round
+		bool changed = true;
+		for (int level = 0; changed; ++level)
+		{
+			changed = false;
+			for (ShockEntry& e : shockOrder)
+			{
+				RigidBody* a = e.constraint->GetBodyA();
+				RigidBody* b = e.constraint->GetBodyB();
+				if (a->stackLevel == level && b->stackLevel < 0) { b->stackLevel = level + 1; changed = true; }
+				else if (b->stackLevel == level && a->stackLevel < 0) { a->stackLevel = level + 1; changed = true; }
+			}
+		}
+
+		// contacts not connected to the ground come last and are solved normally
+		for (ShockEntry& e : shockOrder)
+		{
+			RigidBody* a = e.constraint->GetBodyA();
+			RigidBody* b = e.constraint->GetBodyB();
+			e.level = a->stackLevel < 0 || b->stackLevel < 0 ? INT_MAX : std::max(a->stackLevel, b->stackLevel);
+		}
+		std::stable_sort(shockOrder.begin(), shockOrder.end());
+
+		// the impulses of this sweep only act on one body, they must not be warm started
+		for (ContactConstraint* c : dynamicConstraints)
 		{
-			c->Apply(dt);
+			c->StoreImpulses();
+			c->shockPropagation = true;
 		}
 
-		int maxIterations = iterations; // very important for quality/performance
-		do
+		for (ShockEntry& e : shockOrder)
 		{
-			maxIterations--;
+			RigidBody* a = e.constraint->GetBodyA();
+			RigidBody* b = e.constraint->GetBodyB();
 
-			for (Constraint* c : dynamicConstraints)
+			RigidBody* lower = NULL;
+			if (e.level != INT_MAX && a->stackLevel != b->stackLevel) lower = a->stackLevel < b->stackLevel ? a : b;
+
+			if (lower == NULL || lower->isStatic)
 			{
-				c->Solve(dt);
+				e.constraint->Solve(dt);
+				continue;
 			}
-			for (Constraint* c : persistantConstraints)
+
+			// infinite mass for this contact
+			real inverseMass = lower->inverseMass;
+			rmat3 inertiaTensorInverse = lower->inertiaTensorInverse;
+			lower->isStatic = true;
+			lower->inverseMass = 0;
+			lower->inertiaTensorInverse = rmat3(0);
+
+			e.constraint->Solve(dt);
+
+			lower->isStatic = false;
+			lower->inverseMass = inverseMass;
+			lower->inertiaTensorInverse = inertiaTensorInverse;
+		}
+
+		for (ContactConstraint* c : dynamicConstraints)
+		{
+			c->RestoreImpulses();
+			c->shockPropagation = false;
+		}
+	}
+
+	void addShockEntry(Constraint* c)
+	{
+		RigidBody* a = c->GetBodyA();
+		RigidBody* b = c->GetBodyB();
+		a->stackLevel = a->isStatic ? 0 : -1;
+		b->stackLevel = b->isStatic ? 0 : -1;
+
+		ShockEntry e = { 0, c };
+		shockOrder.push_back(e);
+	}
+
+	// split impulse pass, corrects the penetration with pseudo velocities
+	void solvePositions(real dt, int positionIterations)
+	{
+		for (ContactConstraint* c : dynamicConstraints)
+		{
+			c->contact->UpdateSeparation();
+			c->pseudoImpulseSum = 0;
+		}
+
+		for (int i=0; i<positionIterations; ++i)
+		{
+			for (ContactConstraint* c : dynamicConstraints)
 			{
-				c->Solve(dt);
+				c->SolvePosition(dt);
 			}
 		}
-		while (maxIterations > 0);
+	}
+
+	// setup that stays constant during the iterations, the solve loop only does dot products and clamping
+	void prepare(real dt)
+	{
+		solveAll(PrepareKernel(), dt);
+	}
+
+	void warmStart(real dt)
+	{
+		ApplyKernel kernel;
+		for (ContactConstraint* c : dynamicConstraints) kernel(*c, dt);
+
+		ArrayLoop<ApplyKernel> loop = { kernel, dt };
+		registry.ForEachArray(loop);
+
+		for (Constraint* c : persistantConstraints) c->Apply(dt);
+	}
+
+	void updateSeparations()
+	{
+		for (ContactConstraint* c : dynamicConstraints)
+		{
+			c->contact->UpdateSeparation();
+		}
 	}
 
 };
@@ -16,35 +16,111 @@ class ContactConstraint : public Constraint
 
 public:
 
-	double normalImpulseSum;
-	double tangent1ImpulseSum;
-	double tangent2ImpulseSum;
+	accum normalImpulseSum;
+	accum tangent1ImpulseSum;
+	accum tangent2ImpulseSum;
+	accum pseudoImpulseSum; // split impulse, not warm started
 	Contact* contact;
 
 	bool warm = false;
+	bool splitImpulse = false; // penetration is resolved by SolvePosition instead of the baumgarte term
+	bool shockPropagation = false; // no restitution, the approaching velocity comes from the pushed up layers below
+
+	// nonlinear conjugate gradient (NNCG) state, accumulated impulses as vector (normal, tangent1, tangent2)
+	rvec3 conjugateDirection = rvec3(0);
+	rvec3 impulseSnapshot = rvec3(0);
+
+	// position based dynamics (XPBD) state of the current substep
+	real positionImpulseSum = 0; // normal positional impulse, limits the friction
+	real approachVelocity = 0; // vRel before the position solve, for restitution
 
 	ContactConstraint(Contact* c)
 	{
 		SetContact(c);
 	}
 
+	virtual RigidBody* GetBodyA() { return contact->bodyA; }
+	virtual RigidBody* GetBodyB() { return contact->bodyB; }
+
 	void SetContact(Contact* c)
 	{
 		contact = c;
 		Clear();
 	}
 
+	// contact geometry and accumulated impulses for the snapshots of the physic manager
+	void SaveState(ContactState& s) const
+	{
+		const Contact& c = *contact;
+		s.normal = c.normal;
+		s.location = c.location;
+		s.localLocation = c.localLocation;
+		s.locationB = c.locationB;
+		s.localLocationB = c.localLocationB;
+		s.tangent1 = c.tangent1;
+		s.tangent2 = c.tangent2;
+		s.vA = c.vA;
+		s.vB = c.vB;
+		s.vRel = c.vRel;
+		s.depth = c.depth;
+		s.type = c.type;
+		s.speculative = c.speculative;
+
+		s.normalImpulseSum = normalImpulseSum;
+		s.tangent1ImpulseSum = tangent1ImpulseSum;
+		s.tangent2ImpulseSum = tangent2ImpulseSum;
+		s.pseudoImpulseSum = pseudoImpulseSum;
+		s.conjugateDirection = conjugateDirection;
+		s.impulseSnapshot = impulseSnapshot;
+		s.positionImpulseSum = positionImpulseSum;
+		s.approachVelocity = approachVelocity;
+		s.appliedImpulse = appliedImpulse;
+		s.warm = warm;
+	}
+
+	// the bodies of the contact are set by the caller
+	void RestoreState(const ContactState& s)
+	{
+		Contact& c = *contact;
+		c.normal = s.normal;
+		c.location = s.location;
+		c.localLocation = s.localLocation;
+		c.locationB = s.locationB;
+		c.localLocationB = s.localLocationB;
+		c.tangent1 = s.tangent1;
+		c.tangent2 = s.tangent2;
+		c.vA = s.vA;
+		c.vB = s.vB;
+		c.vRel = s.vRel;
+		c.depth = s.depth;
+		c.type = (ContactType)s.type;
+		c.speculative = s.speculative;
+
+		normalImpulseSum = s.normalImpulseSum;
+		tangent1ImpulseSum = s.tangent1ImpulseSum;
+		tangent2ImpulseSum = s.tangent2ImpulseSum;
+		pseudoImpulseSum = s.pseudoImpulseSum;
+		conjugateDirection = s.conjugateDirection;
+		impulseSnapshot = s.impulseSnapshot;
+		positionImpulseSum = s.positionImpulseSum;
+		approachVelocity = s.approachVelocity;
+		appliedImpulse = s.appliedImpulse;
+		warm = s.warm;
+	}
+
 	void Clear()
 	{
 		normalImpulseSum = 0;
 		tangent1ImpulseSum = 0;
 		tangent2ImpulseSum = 0;
+		pseudoImpulseSum = 0;
 		warm = false;
+		conjugateDirection = rvec3(0);
 	}
 
 	
 	// warm start, reuse lambda from last iteration as initial guess
-	virtual void Apply(double dt)
+	virtual void Apply(real dt)
 	{
 		if (!warm) return;
 
@@ -55,7 +131,7 @@ public:
 			return;
 		}
 
-		double warmStartFactor = 0.7;
+		real warmStartFactor = 0.7;
 
 		// reuse last value completely if bodies inactive (body is completely stable)
 
@@ -64,17 +140,17 @@ public:
 
 		Contact &c = *contact;
 
-		dvec3 ra = c.location - c.bodyA->position;
-		dvec3 rb = c.location - c.bodyB->position;
-		dvec3 raCrossN = cross(ra,c.normal);
-		dvec3 rbCrossN = cross(rb,c.normal);
+		rvec3 ra = c.location - c.bodyA->position;
+		rvec3 rb = c.location - c.bodyB->position;
+		rvec3 raCrossN = cross(ra,c.normal);
+		rvec3 rbCrossN = cross(rb,c.normal);
 
-		dvec3 force = c.normal*normalImpulseSum;
+		rvec3 force = c.normal*real(normalImpulseSum);
 		c.bodyA->ApplyLinearMomentum(force);
 		c.bodyB->ApplyLinearMomentum(-force);
 
-		c.bodyA->ApplyAngularMomentum(raCrossN * normalImpulseSum);
-		c.bodyB->ApplyAngularMomentum(-rbCrossN * normalImpulseSum);
+		c.bodyA->ApplyAngularMomentum(raCrossN * real(normalImpulseSum));
+		c.bodyB->ApplyAngularMomentum(-rbCrossN * real(normalImpulseSum));
 		
 
 		// apply friction
@@ -82,25 +158,27 @@ public:
 		tangent1ImpulseSum *= warmStartFactor;
 		tangent2ImpulseSum *= warmStartFactor;
 
-		force = c.tangent1*tangent1ImpulseSum + c.tangent2*tangent2ImpulseSum;
+		force = c.tangent1*real(tangent1ImpulseSum) + c.tangent2*real(tangent2ImpulseSum);
 
-		dvec3 raCrossT1 = cross(ra,c.tangent1);
-		dvec3 rbCrossT1 = cross(rb,c.tangent1);
-		dvec3 raCrossT2 = cross(ra,c.tangent2);
-		dvec3 rbCrossT2 = cross(rb,c.tangent2);
+		rvec3 raCrossT1 = cross(ra,c.tangent1);
+		rvec3 rbCrossT1 = cross(rb,c.tangent1);
+		rvec3 raCrossT2 = cross(ra,c.tangent2);
+		rvec3 rbCrossT2 = cross(rb,c.tangent2);
 
 		c.bodyA->ApplyLinearMomentum(force);
 		c.bodyB->ApplyLinearMomentum(-force);
 
-		c.bodyA->ApplyAngularMomentum( raCrossT1 * tangent1ImpulseSum  +  raCrossT2*tangent2ImpulseSum);
-		c.bodyB->ApplyAngularMomentum(-rbCrossT1 * tangent1ImpulseSum  + -rbCrossT2*tangent2ImpulseSum);
+		c.bodyA->ApplyAngularMomentum( raCrossT1 * real(tangent1ImpulseSum)  +  raCrossT2*real(tangent2ImpulseSum));
+		c.bodyB->ApplyAngularMomentum(-rbCrossT1 * real(tangent1ImpulseSum)  + -rbCrossT2*real(tangent2ImpulseSum));
 
 
 		warm = false;
 	}
 
-	virtual void Solve(double dt)
+	virtual void Solve(real dt)
 	{
+		appliedImpulse = 0;
+
 		contact->Update();
 		if (contact->type != ContactType::Colliding) return;
 
@@ -115,6 +193,16 @@ public:
 		warm = true;
 	}
 
+	// same as Solve but without pushing the bodies apart, removes the velocity added by the baumgarte term
+	virtual void Relax(real dt)
+	{
+		contact->Update();
+		if (contact->type != ContactType::Colliding) return;
+
+		solveNormal(dt, false);
+		solveTangentCoupled();
+	}
+
 	// http://www.bulletphysics.com/ftp/pub/test/physics/papers/IterativeDynamics.pdf page 12
 	void solveTangentCoupled()
 	{
@@ -122,43 +210,44 @@ public:
 
 		// get V
 		// (vA, omegaA, vB, omegaB)
-		dvec3 vA = c.bodyA->velocity;
-		dvec3 omegaA = c.bodyA->angularVelocity;
-		dvec3 vB = c.bodyB->velocity;
-		dvec3 omegaB = c.bodyB->angularVelocity;
+		rvec3 vA = c.bodyA->velocity;
+		rvec3 omegaA = c.bodyA->angularVelocity;
+		rvec3 vB = c.bodyB->velocity;
+		rvec3 omegaB = c.bodyB->angularVelocity;
 
 		// J = (J1, J2)
 		// J1 =(c.tangent1, raCrossT1, -c.tangent1, -rbCrossT1)'
-		dvec3 ra = c.location - c.bodyA->position;
-		dvec3 rb = c.location - c.bodyB->position;
+		rvec3 ra = c.location - c.bodyA->position;
+		rvec3 rb = c.location - c.bodyB->position;
 
-		dvec3 raCrossT1 = cross(ra,c.tangent1);
-		dvec3 rbCrossT1 = cross(rb,c.tangent1);
+		rvec3 raCrossT1 = cross(ra,c.tangent1);
+		rvec3 rbCrossT1 = cross(rb,c.tangent1);
 		
 		// J2 =(c.tangent2, raCrossT2, -c.tangent2, -rbCrossT2)'
-		dvec3 raCrossT2 = cross(ra,c.tangent2);
-		dvec3 rbCrossT2 = cross(rb,c.tangent2);
+		rvec3 raCrossT2 = cross(ra,c.tangent2);
+		rvec3 rbCrossT2 = cross(rb,c.tangent2);
 
 		// b = 0
 
-		dmat2 mEffInvA = c.bodyA->GetEffectiveMassInverse(c.tangent1, raCrossT1, c.tangent2, raCrossT2);
-		dmat2 mEffInvB = c.bodyB->GetEffectiveMassInverse(-c.tangent1, -rbCrossT1, -c.tangent2, -rbCrossT2);
-		dmat2 effectiveMass = inverse(mEffInvA + mEffInvB);
+		rmat2 mEffInvA = c.bodyA->GetEffectiveMassInverse(c.tangent1, raCrossT1, c.tangent2, raCrossT2);
+		rmat2 mEffInvB = c.bodyB->GetEffectiveMassInverse(-c.tangent1, -rbCrossT1, -c.tangent2, -rbCrossT2);
+		rmat2 effectiveMass = inverse(mEffInvA + mEffInvB);
 
 		// solve (dot(J,V)+b)
-		double deltaV1 = dot(vA, c.tangent1) - dot(vB, c.tangent1) + dot(omegaA, raCrossT1) - dot(omegaB, rbCrossT1);
-		double deltaV2 = dot(vA, c.tangent2) - dot(vB, c.tangent2) + dot(omegaA, raCrossT2) - dot(omegaB, rbCrossT2);
-		dvec2 deltaV(deltaV1, deltaV2);
+		real deltaV1 = dot(vA, c.tangent1) - dot(vB, c.tangent1) + dot(omegaA, raCrossT1) - dot(omegaB, rbCrossT1);
+		real deltaV2 = dot(vA, c.tangent2) - dot(vB, c.tangent2) + dot(omegaA, raCrossT2) - dot(omegaB, rbCrossT2);
+		rvec2 deltaV(deltaV1, deltaV2);
 
-		dvec2 lambda = -effectiveMass * deltaV;
+		rvec2 lambda = -effectiveMass * deltaV;
 
 		// http://www.bulletphysics.com/ftp/pub/test/physics/papers/IterativeDynamics.pdf eqquations 24 and 25
-		//double bound = 0.8*bodyA->frictionCoefficient*bodyB->frictionCoefficient; // should be somewhere about gravity
-		double bound = normalImpulseSum*c.bodyA->friction*c.bodyB->friction;
+		//real bound = 0.8*bodyA->frictionCoefficient*bodyB->frictionCoefficient; // should be somewhere about gravity
+		real bound = normalImpulseSum*c.bodyA->friction*c.bodyB->friction;
 		lambda.x = addAndClampSum(tangent1ImpulseSum, lambda.x, -bound, bound);
 		lambda.y = addAndClampSum(tangent2ImpulseSum, lambda.y, -bound, bound);
+		appliedImpulse += length(lambda);
 
-		dvec3 force = c.tangent1*lambda.x + c.tangent2*lambda.y;
+		rvec3 force = c.tangent1*lambda.x + c.tangent2*lambda.y;
 
 		c.bodyA->ApplyLinearMomentum(force);
 		c.bodyB->ApplyLinearMomentum(-force);
@@ -167,39 +256,39 @@ public:
 		c.bodyB->ApplyAngularMomentum(-rbCrossT1 * lambda.x  + -rbCrossT2*lambda.y);
 	}
 
-	void solveTangent(dvec3 tangent, double& impulseSum)
+	void solveTangent(rvec3 tangent, accum& impulseSum)
 	{
 		Contact& c = *contact;
 
 		// get V
 		// (vA, omegaA, vB, omegaB)
-		dvec3 vA = c.bodyA->velocity;
-		dvec3 omegaA = c.bodyA->angularVelocity;
-		dvec3 vB = c.bodyB->velocity;
-		dvec3 omegaB = c.bodyB->angularVelocity;
+		rvec3 vA = c.bodyA->velocity;
+		rvec3 omegaA = c.bodyA->angularVelocity;
+		rvec3 vB = c.bodyB->velocity;
+		rvec3 omegaB = c.bodyB->angularVelocity;
 
 		// create J:
 		// (tangent, raCrossN, -tangent, -rbCrossN)
-		dvec3 ra = c.location - c.bodyA->position;
-		dvec3 rb = c.location - c.bodyB->position;
-		dvec3 raCrossN = cross(ra,tangent);
-		dvec3 rbCrossN = cross(rb,tangent);
+		rvec3 ra = c.location - c.bodyA->position;
+		rvec3 rb = c.location - c.bodyB->position;
+		rvec3 raCrossN = cross(ra,tangent);
+		rvec3 rbCrossN = cross(rb,tangent);
 
 		// b = 0
 
 		// create effectiveMass = 1/(transpose(J)*MInverse*J)
-		double mEffInvA = c.bodyA->GetEffectiveMassInverse(tangent, raCrossN);
-		double mEffInvB = c.bodyB->GetEffectiveMassInverse(-tangent, -rbCrossN);
-		double effectiveMass = 1./(mEffInvA + mEffInvB);
+		real mEffInvA = c.bodyA->GetEffectiveMassInverse(tangent, raCrossN);
+		real mEffInvB = c.bodyB->GetEffectiveMassInverse(-tangent, -rbCrossN);
+		real effectiveMass = 1./(mEffInvA + mEffInvB);
 
 		// solve (dot(J,V)+b)
-		double deltaV = dot(vA, tangent) - dot(vB, tangent) + dot(omegaA, raCrossN) - dot(omegaB, rbCrossN);
-		double lambda = -effectiveMass * deltaV;
+		real deltaV = dot(vA, tangent) - dot(vB, tangent) + dot(omegaA, raCrossN) - dot(omegaB, rbCrossN);
+		real lambda = -effectiveMass * deltaV;
 
-		double bound = normalImpulseSum*c.bodyA->friction*c.bodyB->friction;
+		real bound = normalImpulseSum*c.bodyA->friction*c.bodyB->friction;
 		lambda = addAndClampSum(impulseSum, lambda, -bound, bound);
 
-		dvec3 force = tangent*lambda;
+		rvec3 force = tangent*lambda;
 
 		c.bodyA->ApplyLinearMomentum(force);
 		c.bodyB->ApplyLinearMomentum(-force);
@@ -208,49 +297,239 @@ public:
 		c.bodyB->ApplyAngularMomentum(-rbCrossN * lambda);
 	}
 
-	void solveNormal(double dt)
-	{ 
+	// NNCG, shock propagation: remember the accumulated impulses before a sweep
+	void StoreImpulses()
+	{
+		impulseSnapshot = rvec3(normalImpulseSum, tangent1ImpulseSum, tangent2ImpulseSum);
+	}
+
+	// reset the accumulated impulses to the ones of the last StoreImpulses
+	void RestoreImpulses()
+	{
+		normalImpulseSum = impulseSnapshot.x;
+		tangent1ImpulseSum = impulseSnapshot.y;
+		tangent2ImpulseSum = impulseSnapshot.z;
+	}
+
+	// NNCG: change of the accumulated impulses by the last sweep (the projected gradient)
+	rvec3 ImpulseChange()
+	{
+		return rvec3(normalImpulseSum, tangent1ImpulseSum, tangent2ImpulseSum) - impulseSnapshot;
+	}
+
+	// NNCG: moves the accumulated impulses beta along the conjugate direction (projected onto the friction cone)
+	// and updates the direction, beta = 0 restarts with the last gradient
+	// reference: Silcowitz et al., A nonsmooth nonlinear conjugate gradient method for interactive contact force problems
+	void ApplyConjugateStep(real beta)
+	{
+		rvec3 gradient = ImpulseChange();
+		rvec3 step = beta*conjugateDirection;
+		conjugateDirection = step + gradient;
+
+		if (beta == 0 || contact->type != ContactType::Colliding) return;
+
 		Contact& c = *contact;
 
-		double restitution = c.bodyA->restitution * c.bodyB->restitution;
-		double restitutionSlopp = 0.01; // http://allenchou.net/2014/01/game-physics-stability-slops/ removes energy to come faster to rest
-		double pushFactor = 0.01; // pushes objects out of each other (http://www.bulletphysics.com/ftp/pub/test/physics/papers/IterativeDynamics.pdf, page 11);
-		double pushSlopp = 0.01; // allowed penetration depth before pushing out
+		accum normal = std::max(normalImpulseSum + step.x, accum(0));
+		accum bound = normal*c.bodyA->friction*c.bodyB->friction;
+		accum tangent1 = std::min(std::max(tangent1ImpulseSum + step.y, -bound), bound);
+		accum tangent2 = std::min(std::max(tangent2ImpulseSum + step.z, -bound), bound);
+
+		real lambdaN = normal - normalImpulseSum;
+		real lambdaT1 = tangent1 - tangent1ImpulseSum;
+		real lambdaT2 = tangent2 - tangent2ImpulseSum;
+		normalImpulseSum = normal;
+		tangent1ImpulseSum = tangent1;
+		tangent2ImpulseSum = tangent2;
+
+		rvec3 ra = c.location - c.bodyA->position;
+		rvec3 rb = c.location - c.bodyB->position;
+
+		rvec3 force = c.normal*lambdaN + c.tangent1*lambdaT1 + c.tangent2*lambdaT2;
+
+		c.bodyA->ApplyLinearMomentum(force);
+		c.bodyB->ApplyLinearMomentum(-force);
+
+		c.bodyA->ApplyAngularMomentum(cross(ra, force));
+		c.bodyB->ApplyAngularMomentum(-cross(rb, force));
+	}
+
+	// split impulse: pushes the bodies apart with pseudo velocities that only change the positions
+	// the velocities are not changed, thus no energy is added by the penetration correction
+	// similar to btSequentialImpulseConstraintSolver::resolveSplitPenetrationImpulse from bullet
+	void SolvePosition(real dt)
+	{
+		Contact& c = *contact;
+
+		real pushFactor = 0.2; // can be much larger than for baumgarte because no energy is added
+		real pushSlopp = 0.01; // allowed penetration depth before pushing out
+
+		rvec3 ra = c.location - c.bodyA->position;
+		rvec3 rb = c.location - c.bodyB->position;
+		rvec3 raCrossN = cross(ra,c.normal);
+		rvec3 rbCrossN = cross(rb,c.normal);
+
+		// relative pseudo velocity
+		rvec3 vA = c.bodyA->pseudoVelocity + cross(c.bodyA->pseudoAngularVelocity, ra);
+		rvec3 vB = c.bodyB->pseudoVelocity + cross(c.bodyB->pseudoAngularVelocity, rb);
+		real vRel = dot(c.normal, vA - vB);
+
+		real b = -pushFactor*std::max(c.depth-pushSlopp,real(0))/dt;
+
+		real mEffInvA = c.bodyA->inverseMass + dot(raCrossN, c.bodyA->inertiaTensorInverse * raCrossN);
+		real mEffInvB = c.bodyB->inverseMass + dot(rbCrossN, c.bodyB->inertiaTensorInverse * rbCrossN);
+		real effectiveMass = 1./(mEffInvA + mEffInvB);
+
+		real lambda = -effectiveMass * (vRel + b);
+		lambda = addAndClampSum(pseudoImpulseSum, lambda);
+
+		c.bodyA->ApplyPseudoImpulse(c.normal*lambda, raCrossN*lambda);
+		c.bodyB->ApplyPseudoImpulse(-c.normal*lambda, -rbCrossN*lambda);
+	}
+
+	// XPBD: resolves the penetration and the static friction on position level (once per substep)
+	// reference: https://matthias-research.github.io/pages/publications/PBDBodies.pdf (section 3.5)
+	virtual void Project(real h)
+	{
+		Contact& c = *contact;
+		c.Update();
+		approachVelocity = c.vRel;
+		positionImpulseSum = 0;
+		appliedImpulse = 0;
+
+		// a small penetration is kept, otherwise the bodies are separated and the collision detection loses the contacts
+		real pushSlopp = 0.001;
+
+		c.UpdateSeparation();
+		if (c.depth <= pushSlopp) return;
+
+		positionImpulseSum = projectPositional(c.bodyA, c.location - c.bodyA->position, c.bodyB, c.locationB - c.bodyB->position, c.normal, c.depth - pushSlopp, h);
+		appliedImpulse = positionImpulseSum;
+
+		// static friction: undo the tangential motion of the contact points during the substep
+		c.UpdateSeparation();
+		rvec3 ra = c.location - c.bodyA->position;
+		rvec3 rb = c.locationB - c.bodyB->position;
+		rvec3 motion = previousMotion(c.bodyA, ra) - previousMotion(c.bodyB, rb);
+		rvec3 tangentMotion = motion - c.normal * dot(c.normal, motion);
+		real slide = length(tangentMotion);
+		if (slide < 1e-12) return;
+
+		rvec3 t = -tangentMotion / slide;
+		real w = c.bodyA->GetEffectiveMassInverse(t, cross(ra, t)) + c.bodyB->GetEffectiveMassInverse(t, cross(rb, t));
+		real friction = c.bodyA->friction * c.bodyB->friction;
+		if (w > 0 && slide / w < friction * positionImpulseSum)
+		{
+			projectPositional(c.bodyA, ra, c.bodyB, rb, t, slide, h);
+		}
+	}
+
+	// XPBD: dynamic friction and restitution on velocity level, after the velocities were derived from the positions
+	void SolveVelocity(real h)
+	{
+		if (positionImpulseSum <= 0) return;
+
+		Contact& c = *contact;
+		c.Update();
+
+		rvec3 v = c.vA - c.vB;
+		rvec3 vt = v - c.normal * c.vRel;
+		real vtLength = length(vt);
+
+		rvec3 deltaV(0);
+		real friction = c.bodyA->friction * c.bodyB->friction;
+		if (vtLength > 1e-12) deltaV -= vt / vtLength * std::min(friction * positionImpulseSum / h, vtLength);
+
+		// restitution of the velocity before the substep, small velocities come to rest
+		real restitution = c.bodyA->restitution * c.bodyB->restitution;
+		real restitutionSlopp = 0.01;
+		if (approachVelocity > -restitutionSlopp) restitution = 0;
+		deltaV += c.normal * (-c.vRel + std::max(-restitution * approachVelocity, real(0)));
+
+		real deltaLength = length(deltaV);
+		if (deltaLength < 1e-12) return;
+
+		rvec3 dir = deltaV / deltaLength;
+		rvec3 ra = c.location - c.bodyA->position;
+		rvec3 rb = c.location - c.bodyB->position;
+		real w = c.bodyA->GetEffectiveMassInverse(dir, cross(ra, dir)) + c.bodyB->GetEffectiveMassInverse(dir, cross(rb, dir));
+		if (w <= 0) return;
+
+		rvec3 impulse = deltaV / w;
+		c.bodyA->ApplyLinearMomentum(impulse);
+		c.bodyA->ApplyAngularMomentum(cross(ra, impulse));
+		c.bodyB->ApplyLinearMomentum(-impulse);
+		c.bodyB->ApplyAngularMomentum(-cross(rb, impulse));
+	}
+
+	// bias b of the normal constraint JV+b>=0 (restitution, baumgarte, speculative gap), uses vRel of the last contact update
+	real normalBias(real dt, bool useBias = true)
+	{
+		Contact& c = *contact;
+
+		real restitution = c.bodyA->restitution * c.bodyB->restitution;
+		real restitutionSlopp = 0.01; // http://allenchou.net/2014/01/game-physics-stability-slops/ removes energy to come faster to rest
+		real pushFactor = 0.01; // pushes objects out of each other (http://www.bulletphysics.com/ftp/pub/test/physics/papers/IterativeDynamics.pdf, page 11);
+		real pushSlopp = 0.01; // allowed penetration depth before pushing out
+
+		real b;
+		if (c.depth < 0)
+		{
+			// speculative contact: the bodies may approach until the gap is closed
+			b = -c.depth/dt;
+		}
+		else
+		{
+			b = shockPropagation ? 0 : restitution * std::min(c.vRel + restitutionSlopp, real(0));
+
+			// Baumgarte Stabilization: pushes body out of each other -> adds jiggle
+			if (useBias && !splitImpulse) b -= pushFactor*std::max(c.depth-pushSlopp,real(0))/dt;
+		}
+		return b;
+	}
+
+	// displacement of the point r (relative to the center) of the body since the beginning of the substep
+	static rvec3 previousMotion(RigidBody* body, rvec3 r)
+	{
+		rvec3 previousR = body->previousRotation * (inverse(body->rotation) * r);
+		return body->position + r - body->previousPosition - previousR;
+	}
+
+	void solveNormal(real dt, bool useBias = true)
+	{ 
+		Contact& c = *contact;
 
 		// get V
 		// (vA, omegaA, vB, omegaB)
-		dvec3 vA = c.bodyA->velocity;
-		dvec3 omegaA = c.bodyA->angularVelocity;
-		dvec3 vB = c.bodyB->velocity;
-		dvec3 omegaB = c.bodyB->angularVelocity;
+		rvec3 vA = c.bodyA->velocity;
+		rvec3 omegaA = c.bodyA->angularVelocity;
+		rvec3 vB = c.bodyB->velocity;
+		rvec3 omegaB = c.bodyB->angularVelocity;
 
 		// create J:
 		// (c.normal, raCrossN, -c.normal, -rbCrossN)
-		dvec3 ra = c.location - c.bodyA->position;
-		dvec3 rb = c.location - c.bodyB->position;
-		dvec3 raCrossN = cross(ra,c.normal);
-		dvec3 rbCrossN = cross(rb,c.normal);
+		rvec3 ra = c.location - c.bodyA->position;
+		rvec3 rb = c.location - c.bodyB->position;
+		rvec3 raCrossN = cross(ra,c.normal);
+		rvec3 rbCrossN = cross(rb,c.normal);
 
 		// create bias
-		double b = restitution * std::min(c.vRel + restitutionSlopp, 0.0);
-
-		// Baumgarte Stabilization: pushes body out of each other -> adds jiggle
-		b -= pushFactor*std::max(c.depth-pushSlopp,0.0)/dt;
+		real b = normalBias(dt, useBias);
 
 
 		// create Minverse
-		double mEffInvA = c.bodyA->inverseMass + dot(raCrossN, c.bodyA->inertiaTensorInverse * raCrossN);
-		double mEffInvB = c.bodyB->inverseMass + dot(rbCrossN, c.bodyB->inertiaTensorInverse * rbCrossN);
+		real mEffInvA = c.bodyA->inverseMass + dot(raCrossN, c.bodyA->inertiaTensorInverse * raCrossN);
+		real mEffInvB = c.bodyB->inverseMass + dot(rbCrossN, c.bodyB->inertiaTensorInverse * rbCrossN);
 
-		//double mEffInvB = c.bodyB->GetEffectiveMassInverse(-c.normal, -rbCrossN);
-		//double mEffInvA = c.bodyA->GetEffectiveMassInverse(c.normal, raCrossN);
+		//real mEffInvB = c.bodyB->GetEffectiveMassInverse(-c.normal, -rbCrossN);
+		//real mEffInvA = c.bodyA->GetEffectiveMassInverse(c.normal, raCrossN);
 		
-		double effectiveMass = 1./(mEffInvA + mEffInvB);
+		real effectiveMass = 1./(mEffInvA + mEffInvB);
 
 		// solve (dot(J,V)+b)
-		//double deltaV = dot(vA, c.normal) - dot(vB, c.normal) + dot(omegaA, raCrossN) - dot(omegaB, rbCrossN) + b;
-		double deltaV = c.vRel + b;
-		double lambda = -effectiveMass * deltaV;
+		//real deltaV = dot(vA, c.normal) - dot(vB, c.normal) + dot(omegaA, raCrossN) - dot(omegaB, rbCrossN) + b;
+		real deltaV = c.vRel + b;
+		real lambda = -effectiveMass * deltaV;
 
 		/*std::cout << "c.n= " << to_string(c.normal) << "l=" << lambda << " em= " << effectiveMass << 
 				" va=" << to_string(vA) << " vb= " << to_string(vB) << " oA= " << to_string(omegaA) << " oB= " << to_string(omegaB)  << 
@@ -259,8 +538,9 @@ public:
 		assert(!isnan(c.normal.x));*/
 
 		lambda = addAndClampSum(normalImpulseSum, lambda);
+		appliedImpulse += std::abs(lambda);
 
-		dvec3 force = c.normal*lambda;
+		rvec3 force = c.normal*lambda;
 
 		c.bodyA->ApplyLinearMomentum(force);
 		c.bodyB->ApplyLinearMomentum(-force);
@@ -0,0 +1,253 @@
+#pragma once
+
+#include "RigidBody.h"
+#include "constraint/Constraint.h"
+#include "constraint/ContactConstraint.h"
+#include "collision/ContactManifold.h"
+
+#define MAX_BLOCK_CONTACTS 4
+
+/*
+ * Solves the normal impulses of all contacts of a manifold together as a small LCP:
+ *   w = K*x + b, x >= 0, w >= 0, x*w = 0
+ * by direct enumeration of the active sets (the accumulated impulses are the unknowns),
+ * the friction is solved afterwards per contact with solveTangentCoupled.
+ * reference: box2d b2ContactSolver (block solver for 2 points) and
+ * http://www.bulletphysics.com/ftp/pub/test/physics/papers/IterativeDynamics.pdf
+ */
+class ContactManifoldConstraint : public Constraint
+{
+
+public:
+	ContactManifold* manifold;
+
+	ContactManifoldConstraint(ContactManifold* m)
+	{
+		manifold = m;
+	}
+
+	virtual RigidBody* GetBodyA() { return manifold->bodyA; }
+	virtual RigidBody* GetBodyB() { return manifold->bodyB; }
+
+	virtual void Solve(real dt)
+	{
+		solve(dt, true);
+	}
+
+	virtual void Relax(real dt)
+	{
+		solve(dt, false);
+	}
+
+private:
+	ContactConstraint* cs[MAX_BLOCK_CONTACTS];
+	int n;
+
+	// solves A*x = b for the first m unknowns with partial pivoting, false if A is (nearly) singular
+	static bool solveDense(real A[MAX_BLOCK_CONTACTS][MAX_BLOCK_CONTACTS], real b[MAX_BLOCK_CONTACTS], real x[MAX_BLOCK_CONTACTS], int m)
+	{
+		real scale = 0;
+		for (int i=0; i<m; ++i) scale = std::max(scale, std::abs(A[i][i]));
+
+		for (int col=0; col<m; ++col)
+		{
+			int pivot = col;
+			for (int row=col+1; row<m; ++row)
+			{
+				if (std::abs(A[row][col]) > std::abs(A[pivot][col])) pivot = row;
+			}
+			if (std::abs(A[pivot][col]) <= 1e-9*scale) return false;
+
+			if (pivot != col)
+			{
+				for (int k=0; k<m; ++k) std::swap(A[col][k], A[pivot][k]);
+				std::swap(b[col], b[pivot]);
+			}
+
+			for (int row=col+1; row<m; ++row)
+			{
+				real f = A[row][col]/A[col][col];
+				for (int k=col; k<m; ++k) A[row][k] -= f*A[col][k];
+				b[row] -= f*b[col];
+			}
+		}
+
+		for (int row=m-1; row>=0; --row)
+		{
+			real sum = b[row];
+			for (int k=row+1; k<m; ++k) sum -= A[row][k]*x[k];
+			x[row] = sum/A[row][row];
+		}
+		return true;
+	}
+
+	void solve(real dt, bool useBias)
+	{
+		appliedImpulse = 0;
+
+		n = 0;
+		for (Contact* c : manifold->contacts)
+		{
+			c->Update();
+			if (c->type != ContactType::Colliding || n == MAX_BLOCK_CONTACTS) continue;
+			cs[n++] = c->constraint;
+		}
+
+		if (n == 0) return;
+		for (int i=0; i<n; ++i) cs[i]->appliedImpulse = 0;
+
+		if (n == 1 || !solveNormalBlock(dt, useBias))
+		{
+			// single contact or no solution found (degenerate), solve sequentially
+			for (int i=0; i<n; ++i) cs[i]->solveNormal(dt, useBias);
+		}
+
+		for (int i=0; i<n; ++i)
+		{
+			cs[i]->solveTangentCoupled();
+			if (useBias) cs[i]->warm = true;
+			appliedImpulse += cs[i]->appliedImpulse;
+		}
+	}
+
+	bool solveNormalBlock(real dt, bool useBias)
+	{
+		RigidBody* A = cs[0]->contact->bodyA;
+		RigidBody* B = cs[0]->contact->bodyB;
+
+		rvec3 normal[MAX_BLOCK_CONTACTS];
+		rvec3 raCrossN[MAX_BLOCK_CONTACTS];
+		rvec3 rbCrossN[MAX_BLOCK_CONTACTS];
+		rvec3 iaRaCrossN[MAX_BLOCK_CONTACTS]; // inertiaTensorInverse * raCrossN
+		rvec3 ibRbCrossN[MAX_BLOCK_CONTACTS];
+		real a[MAX_BLOCK_CONTACTS]; // accumulated impulses so far
+		real bPrime[MAX_BLOCK_CONTACTS]; // w = K*x + bPrime
+		real K[MAX_BLOCK_CONTACTS][MAX_BLOCK_CONTACTS];
+
+		for (int i=0; i<n; ++i)
+		{
+			Contact& c = *cs[i]->contact;
+			normal[i] = c.normal;
+			raCrossN[i] = cross(c.location - A->position, c.normal);
+			rbCrossN[i] = cross(c.location - B->position, c.normal);
+			iaRaCrossN[i] = A->inertiaTensorInverse * raCrossN[i];
+			ibRbCrossN[i] = B->inertiaTensorInverse * rbCrossN[i];
+			a[i] = cs[i]->normalImpulseSum;
+		}
+
+		for (int i=0; i<n; ++i)
+		{
+			for (int j=0; j<n; ++j)
+			{
+				K[i][j] = (A->inverseMass + B->inverseMass)*dot(normal[i], normal[j]) +
+					dot(raCrossN[i], iaRaCrossN[j]) + dot(rbCrossN[i], ibRbCrossN[j]);
+			}
+		}
+
+		for (int i=0; i<n; ++i)
+		{
+			// vRel was updated in solve
+			bPrime[i] = cs[i]->contact->vRel + cs[i]->normalBias(dt, useBias);
+			for (int j=0; j<n; ++j) bPrime[i] -= K[i][j]*a[j];
+		}
+
+		// enumerate the active sets, the ones with more active contacts first
+		real x[MAX_BLOCK_CONTACTS];
+		bool found = false;
+		for (int active=n; active>=0 && !found; --active)
+		{
+			for (int mask=(1<<n)-1; mask>=0 && !found; --mask)
+			{
+				if (bitCount(mask) != active) continue;
+				found = tryActiveSet(mask, K, bPrime, x);
+			}
+		}
+		if (!found) return false;
+
+		// apply the difference to the accumulated impulses
+		rvec3 linear(0);
+		rvec3 angularA(0);
+		rvec3 angularB(0);
+		for (int i=0; i<n; ++i)
+		{
+			real lambda = x[i] - a[i];
+			cs[i]->normalImpulseSum = x[i];
+			cs[i]->appliedImpulse += std::abs(lambda);
+
+			linear += normal[i]*lambda;
+			angularA += raCrossN[i]*lambda;
+			angularB += rbCrossN[i]*lambda;
+		}
+
+		A->ApplyLinearMomentum(linear);
+		B->ApplyLinearMomentum(-linear);
+		A->ApplyAngularMomentum(angularA);
+		B->ApplyAngularMomentum(-angularB);
+
+		return true;
+	}
+
+	// solves K_SS*x_S = -bPrime_S for the active contacts S, valid if x_S >= 0 and w >= 0 for the others
+	bool tryActiveSet(int mask, real K[MAX_BLOCK_CONTACTS][MAX_BLOCK_CONTACTS], real bPrime[MAX_BLOCK_CONTACTS], real x[MAX_BLOCK_CONTACTS])
+	{
+		const real tolerance = 1e-6; // coplanar contacts have a singular K, the dropped one is only satisfied approximately
+
+		int index[MAX_BLOCK_CONTACTS];
+		int m = 0;
+		for (int i=0; i<n; ++i)
+		{
+			x[i] = 0;
+			if (mask & (1<<i)) index[m++] = i;
+		}
+
+		if (m > 0)
+		{
+			real Kss[MAX_BLOCK_CONTACTS][MAX_BLOCK_CONTACTS];
+			real rhs[MAX_BLOCK_CONTACTS];
+			real xs[MAX_BLOCK_CONTACTS];
+			for (int i=0; i<m; ++i)
+			{
+				for (int j=0; j<m; ++j) Kss[i][j] = K[index[i]][index[j]];
+				rhs[i] = -bPrime[index[i]];
+			}
+
+			if (!solveDense(Kss, rhs, xs, m)) return false;
+
+			for (int i=0; i<m; ++i)
+			{
+				if (xs[i] < 0) return false;
+				x[index[i]] = xs[i];
+			}
+		}
+
+		for (int i=0; i<n; ++i)
+		{
+			if (mask & (1<<i)) continue;
+
+			real w = bPrime[i];
+			for (int j=0; j<n; ++j) w += K[i][j]*x[j];
+			if (w < -tolerance) return false;
+		}
+		return true;
+	}
+
+	static int bitCount(int mask)
+	{
+		int count = 0;
+		for (; mask; mask >>= 1) count += mask & 1;
+		return count;
+	}
+};
+
+
+ContactManifold::ContactManifold()
+{
+	constraint = new ContactManifoldConstraint(this);
+}
+
+ContactManifold::~ContactManifold()
+{
+	Clear();
+	delete constraint;
+	constraint = 0;
+}
@@ -11,11 +11,18 @@ class DistanceConstraint : public Constraint
 
 public:
 
-	dvec3 p;
+	rvec3 p;
 	RigidBody* body;
-	double L;
+	real L;
 
-	DistanceConstraint(RigidBody* body, dvec3 point)
+private:
+	// cached by Prepare
+	rvec3 J;
+	real b;
+	real effectiveMass;
+
+public:
+	DistanceConstraint(RigidBody* body, rvec3 point)
 	{
 		this->p = point;
 		this->body = body;
@@ -23,32 +30,59 @@ public:
 		this->body->SetSleepingEnabled(false);
 	}
 
-	virtual void Solve(double dt)
-	{
-		// get V
-		// (vA)
-		dvec3 vA = body->velocity;
+	virtual RigidBody* GetBodyA() { return body; }
 
+	virtual void Prepare(real dt)
+	{
 		// create J:
 		// (x/norm(x))
-		dvec3 J = normalize(body->position-p);
+		J = normalize(body->position-p);
 
 		// correct distance
-		double b = length(body->position - p) - L;	
+		b = length(body->position - p) - L;	
 		// thomaset: from where do we get this factor b, it's not time dependent?!, according to slide 25: b = 0
 		// wolftho: not in the slides, but this keeps the distance (like baumgarten)
 
 		// effective mass
-		double effectiveMass = 1./(body->inverseMass);
+		effectiveMass = 1./(body->inverseMass);
+	}
+
+	virtual void Solve(real dt)
+	{
+		solve(true);
+	}
+
+	// iteration after the positions were integrated (temporal gauss seidel): prepared jacobians, no baumgarte bias
+	virtual void Relax(real dt)
+	{
+		solve(false);
+	}
+
+	// XPBD: moves the body along the line to the point until the distance is L
+	virtual void Project(real h)
+	{
+		const rvec3 d = p - body->position;
+		const real distance = length(d);
+		if (distance < 1e-12) return;
+
+		appliedImpulse = std::abs(projectPositional(body, rvec3(0), NULL, rvec3(0), d/distance, distance - L, h));
+	}
 
+private:
+
+	void solve(bool bias)
+	{
+		// get V
+		// (vA)
+		rvec3 vA = body->velocity;
 
 		// solve (dot(J,V)+b)
-		double deltaV = dot(vA, J) + b;
-		double lambda = -effectiveMass * deltaV;
+		real deltaV = dot(vA, J) + (bias ? b : 0);
+		real lambda = -effectiveMass * deltaV;
+		appliedImpulse = std::abs(lambda);
 
-		dvec3 force = J*lambda;
+		rvec3 force = J*lambda;
 
 		body->ApplyLinearMomentum(force);
 	}
-
 };
@@ -12,14 +12,24 @@ public:
 	RigidBody* bodyA;	/// optional TODO: accept none rigidbody two allow single body hinges as in DistanceConstraint
 	RigidBody* bodyB;
 	
-	dvec3 aA_loc;	// local axis of hinge of bodyA
-	dvec3 aB_loc;	// local axis of hinge of bodyB
-	dvec3 pA_loc;	// local anchor Point of bodyA
-	dvec3 pB_loc;	// local anchor Point of bodyB
+	rvec3 aA_loc;	// local axis of hinge of bodyA
+	rvec3 aB_loc;	// local axis of hinge of bodyB
+	rvec3 pA_loc;	// local anchor Point of bodyA
+	rvec3 pB_loc;	// local anchor Point of bodyB
 
+private:
+	// cached by Prepare
+	rmat3 J1, J2, J3, J4;
+	rvec3 J12, J14, J22, J24;
+	rmat3 K_transInv;
+	rmat2 K_rotInv;
+	rvec3 biasTrans;
+	rvec2 biasRot;
+
+public:
 	/// a_global: global axis of hinge
 	/// p_global: global anchor point of hinge
-	HingeConstraint(RigidBody* bodyA_In, RigidBody* bodyB_In, dvec3 a_global, dvec3 p_global)
+	HingeConstraint(RigidBody* bodyA_In, RigidBody* bodyB_In, rvec3 a_global, rvec3 p_global)
 	{
 		this->bodyA = bodyA_In;
 		this->bodyB = bodyB_In;
@@ -27,8 +37,8 @@ public:
 		this->bodyA->SetSleepingEnabled(false);
 		this->bodyB->SetSleepingEnabled(false);
 
-		const dmat3 RA = glm::mat3_cast(bodyA->rotation);
-		const dmat3 RB = glm::mat3_cast(bodyB->rotation);
+		const rmat3 RA = glm::mat3_cast(bodyA->rotation);
+		const rmat3 RB = glm::mat3_cast(bodyB->rotation);
 		
 		/// correct?
 		this->aA_loc = normalize(inverse(RA)*a_global);
@@ -38,95 +48,99 @@ public:
 		this->pB_loc = bodyB->GlobalToLocal(p_global);
 		
 	}
+
+	virtual RigidBody* GetBodyA() { return bodyA; }
+	virtual RigidBody* GetBodyB() { return bodyB; }
+
 	// Constraints
 	// C_trans = x2+r2-x1-r1
 	// C_rot = [dot(a1,b2); dot(a1,c1)]
-	virtual void Solve(double dt)
+	virtual void Prepare(real dt)
 	{
 		// transform local coordinates back to global
 		/// TODO: could be done more efficient with only the rotation matrix	
-		const dvec3 x1 = bodyA->position;
-		const dvec3 x2 = bodyB->position;
-		const dvec3 a1 = normalize(bodyA->LocalToGlobal(this->aA_loc)-x1);
-		const dvec3 a2 = normalize(bodyB->LocalToGlobal(this->aB_loc)-x2);
-		const dvec3 r1 = bodyA->LocalToGlobal(this->pA_loc)-x1;	/// r1 is from body center to anchor point
-		const dvec3 r2 = bodyB->LocalToGlobal(this->pB_loc)-x2;	/// r2 is from body center to anchor point
+		const rvec3 x1 = bodyA->position;
+		const rvec3 x2 = bodyB->position;
+		const rvec3 a1 = normalize(bodyA->LocalToGlobal(this->aA_loc)-x1);
+		const rvec3 a2 = normalize(bodyB->LocalToGlobal(this->aB_loc)-x2);
+		const rvec3 r1 = bodyA->LocalToGlobal(this->pA_loc)-x1;	/// r1 is from body center to anchor point
+		const rvec3 r2 = bodyB->LocalToGlobal(this->pB_loc)-x2;	/// r2 is from body center to anchor point
 		
 		// get normal vectors to a_2		
-		const dvec3 b2 = GetAOrthogonalVector(a2);
-		const dvec3 c2 = cross(a2, b2);
+		const rvec3 b2 = GetAOrthogonalVector(a2);
+		const rvec3 c2 = cross(a2, b2);
 		
 		// create J_trans:
 		// J = [J1, J2, J3, J4]
-		const dmat3 J1 = -dmat3(1);
-		const dmat3 J2 = GetSkewCrossMatrix(r1);
-		const dmat3 J3 = dmat3(1);
-		const dmat3 J4 = -GetSkewCrossMatrix(r2);
+		J1 = -rmat3(1);
+		J2 = GetSkewCrossMatrix(r1);
+		J3 = rmat3(1);
+		J4 = -GetSkewCrossMatrix(r2);
 		
 		// create mass matrix for translation
-		const dmat3 K_trans = this->bodyA->GetEffectiveMassInverse(J1,J2) + this->bodyB->GetEffectiveMassInverse(J3,J4);
+		const rmat3 K_trans = this->bodyA->GetEffectiveMassInverse(J1,J2) + this->bodyB->GetEffectiveMassInverse(J3,J4);
+		K_transInv = inverse(K_trans);
 		
 		// create J_rot:
 		// J = [	J11, J12, J13, J14;
 		//			J21, J22, J23, J24;]
-		const dvec3 J11 = dvec3(0);
-		const dvec3 J12 = -cross(b2,a1);
-		const dvec3 J13 = dvec3(0);
-		const dvec3 J14 = cross(b2,a1);
-		const dvec3 J21 = dvec3(0);
-		const dvec3 J22 = -cross(c2,a1);
-		const dvec3 J23 = dvec3(0);
-		const dvec3 J24 = cross(c2,a1);
+		const rvec3 J11 = rvec3(0);
+		J12 = -cross(b2,a1);
+		const rvec3 J13 = rvec3(0);
+		J14 = cross(b2,a1);
+		const rvec3 J21 = rvec3(0);
+		J22 = -cross(c2,a1);
+		const rvec3 J23 = rvec3(0);
+		J24 = cross(c2,a1);
 	
 		// crete mass matrix for rotation
-		const dmat2 K_rot = this->bodyA->GetEffectiveMassInverse(J11, J12, J21, J22) + this->bodyB->GetEffectiveMassInverse(J13,J14,J23,J24);
+		const rmat2 K_rot = this->bodyA->GetEffectiveMassInverse(J11, J12, J21, J22) + this->bodyB->GetEffectiveMassInverse(J13,J14,J23,J24);
+		K_rotInv = inverse(K_rot);
 
-		// get V
-		// (vA, omegaA, vB, omegaB)
-		const dvec3 v1 = bodyA->velocity;
-		const dvec3 omega1 = bodyA->angularVelocity;
-		const dvec3 v2 = bodyB->velocity;
-		const dvec3 omega2 = bodyB->angularVelocity;
-		
 		// baumgarte stabilization
-		const double beta = 0.01;
-		const dvec3 C_trans = x2+r2-x1-r1;
-		const dvec2 C_rot(dot(a1,b2), dot(a1,c2));
-		
-		// --- solve translation constraints ---
-		const dvec3 deltaVTrans = J1*v1 + J2*omega1 + J3*v2 + J4*omega2 + beta/dt*C_trans;
-		const dvec3 lambdaTrans = -inverse(K_trans)*deltaVTrans;
+		const real beta = 0.01;
+		const rvec3 C_trans = x2+r2-x1-r1;
+		const rvec2 C_rot(dot(a1,b2), dot(a1,c2));
+		biasTrans = beta/dt*C_trans;
+		biasRot = C_rot;
+	}
 
-		const dvec3 impulseLinear1 = J1*lambdaTrans;
-		dvec3 impulseAngular1 = -J2*lambdaTrans;	/// thomaset: why the heck has a minus to be here? Only works like this...
-		const dvec3 impulseLinear2 = J3*lambdaTrans;
-		dvec3 impulseAngular2 = -J4*lambdaTrans;	/// thomaset: why the heck has a minus to be here? Only works like this...
+	virtual void Solve(real dt)
+	{
+		solve(true);
+	}
 
-		// --- solve rotation constraints ---
-		const dvec2 deltaVRot(	dot(J12,omega1) + dot(J14,omega2) + C_rot[0],
-							dot(J22,omega1) + dot(J24,omega2) + C_rot[1]);
-		const dvec2 lambdaRot = -inverse(K_rot)*deltaVRot;
-		
-		impulseAngular1 += J12*lambdaRot[0] + J22*lambdaRot[1];
-		impulseAngular2 += J14*lambdaRot[0] + J24*lambdaRot[1];
-		
-		// --- Apply the impulses --	
-		bodyA->ApplyLinearMomentum(impulseLinear1);
-		bodyA->ApplyAngularMomentum(impulseAngular1);
-		
-		bodyB->ApplyLinearMomentum(impulseLinear2);
-		bodyB->ApplyAngularMomentum(impulseAngular2);
+	// iteration after the positions were integrated (temporal gauss seidel): prepared jacobians, no baumgarte bias
+	virtual void Relax(real dt)
+	{
+		solve(false);
+	}
+
+	// XPBD: aligns the hinge axes, then moves the two anchor points onto each other
+	virtual void Project(real h)
+	{
+		const rvec3 a1 = normalize(bodyA->LocalToGlobal(this->aA_loc)-bodyA->position);
+		const rvec3 a2 = normalize(bodyB->LocalToGlobal(this->aB_loc)-bodyB->position);
+		real lambdaRot = projectAngular(bodyA, bodyB, cross(a1, a2), h);
+
+		const rvec3 pA = bodyA->LocalToGlobal(this->pA_loc);
+		const rvec3 pB = bodyB->LocalToGlobal(this->pB_loc);
+		const real C = length(pB - pA);
+		real lambdaTrans = 0;
+		if (C > 1e-12) lambdaTrans = projectPositional(bodyA, pA - bodyA->position, bodyB, pB - bodyB->position, (pB - pA)/C, C, h);
+
+		appliedImpulse = std::abs(lambdaRot) + std::abs(lambdaTrans);
 	}
 	
 	// retruns an "arbitrarly" orthogonal vector to v1
-	dvec3 GetAOrthogonalVector(const dvec3 v1) const{
-		const dvec3 tmp(v1[1], v1[2], v1[0]);		// prevent co-linearity
+	rvec3 GetAOrthogonalVector(const rvec3 v1) const{
+		const rvec3 tmp(v1[1], v1[2], v1[0]);		// prevent co-linearity
 		return normalize(cross(tmp, v1));
 	}
 	
 	// https://en.wikipedia.org/wiki/Skew-symmetric_matrix#Cross_product
-	dmat3 GetSkewCrossMatrix(const dvec3 v1) const{
-		dmat3 result(0);
+	rmat3 GetSkewCrossMatrix(const rvec3 v1) const{
+		rmat3 result(0);
 		result[1][0] = -v1[2];
 		result[2][0] = v1[1];
 		
@@ -137,4 +151,42 @@ public:
 		result[1][2] = v1[0];
 		return result;
 	}
+
+private:
+
+	void solve(bool bias)
+	{
+		// get V
+		// (vA, omegaA, vB, omegaB)
+		const rvec3 v1 = bodyA->velocity;
+		const rvec3 omega1 = bodyA->angularVelocity;
+		const rvec3 v2 = bodyB->velocity;
+		const rvec3 omega2 = bodyB->angularVelocity;
+		
+		// --- solve translation constraints ---
+		const rvec3 deltaVTrans = J1*v1 + J2*omega1 + J3*v2 + J4*omega2 + (bias ? biasTrans : rvec3(0));
+		const rvec3 lambdaTrans = -K_transInv*deltaVTrans;
+
+		const rvec3 impulseLinear1 = J1*lambdaTrans;
+		rvec3 impulseAngular1 = -J2*lambdaTrans;	/// thomaset: why the heck has a minus to be here? Only works like this...
+		const rvec3 impulseLinear2 = J3*lambdaTrans;
+		rvec3 impulseAngular2 = -J4*lambdaTrans;	/// thomaset: why the heck has a minus to be here? Only works like this...
+
+		// --- solve rotation constraints ---
+		const rvec2 rot = bias ? biasRot : rvec2(0);
+		const rvec2 deltaVRot(	dot(J12,omega1) + dot(J14,omega2) + rot[0],
+							dot(J22,omega1) + dot(J24,omega2) + rot[1]);
+		const rvec2 lambdaRot = -K_rotInv*deltaVRot;
+		
+		impulseAngular1 += J12*lambdaRot[0] + J22*lambdaRot[1];
+		impulseAngular2 += J14*lambdaRot[0] + J24*lambdaRot[1];
+		appliedImpulse = length(lambdaTrans) + length(lambdaRot);
+		
+		// --- Apply the impulses --	
+		bodyA->ApplyLinearMomentum(impulseLinear1);
+		bodyA->ApplyAngularMomentum(impulseAngular1);
+		
+		bodyB->ApplyLinearMomentum(impulseLinear2);
+		bodyB->ApplyAngularMomentum(impulseAngular2);
+	}
 };
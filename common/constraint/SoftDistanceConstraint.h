@@ -2,8 +2,9 @@
 
 #include "constraint/Constraint.h"
 
-/* 
- * Enforces the distance between a rigidBody and a point
+/*
+ * Enforces the distance between a rigidBody and a point, softened by stiffness and damping
+ * (implicit, stable at the normal timestep for stiff settings as well)
  * similar to (slide 25): http://twvideo01.ubm-us.net/o1/vault/gdc09/slides/04-GDC09_Catto_Erin_Solver.pdf
  */
 class SoftDistanceConstraint : public Constraint
@@ -11,47 +12,85 @@ class SoftDistanceConstraint : public Constraint
 
 public:
 
-	dvec3 p;
+	rvec3 p;
 	RigidBody* body;
-	double L;
+	real L;
+	real stiffness;
+	real damping;
 
-	SoftDistanceConstraint(RigidBody* body, dvec3 point)
+private:
+	// cached by Prepare
+	rvec3 J;
+	real bias;
+	real gamma;
+	real effectiveMass;
+
+	accum impulseSum = 0; // accumulated over the iterations of a step, the softness depends on it
+
+public:
+	SoftDistanceConstraint(RigidBody* body, rvec3 point, real stiffness = 1000, real damping = 10)
 	{
 		this->p = point;
 		this->body = body;
 		this->L = length(body->position - p); // save initial distance
+		this->stiffness = stiffness;
+		this->damping = damping;
 		this->body->SetSleepingEnabled(false);
 	}
 
-	virtual void Solve(double dt)
+	virtual RigidBody* GetBodyA() { return body; }
+
+	virtual void Prepare(real dt)
 	{
-		// get V
-		// (vA)
-		dvec3 vA = body->velocity;
+		impulseSum = 0;
 
 		// create J:
 		// (x/norm(x))
-		dvec3 J = normalize(body->position-p);
+		J = normalize(body->position-p);
+
+		// soft parameters
+		real beta;
+		if (!softParameters(stiffness, damping, dt, gamma, beta) || body->inverseMass == 0)
+		{
+			effectiveMass = 0;
+			return;
+		}
 
 		// correct distance
-		double b = length(body->position - p) - L;	
+		bias = beta/dt * (length(body->position - p) - L);
 
-		// soft parameter
-		// http://www.ode.org/ode-latest-userguide.html#sec_3_8_0
-		double CFM = 0.50;
-		
 		// effective mass
-		double effectiveMass = 1./(body->inverseMass + CFM/dt);
+		effectiveMass = 1./(body->inverseMass + gamma);
+	}
 
-		
+	virtual void Solve(real dt)
+	{
+		appliedImpulse = 0;
+		if (effectiveMass == 0) return;
+
+		// get V
+		// (vA)
+		rvec3 vA = body->velocity;
 
-		// solve (dot(J,V)+b)
-		double deltaV = dot(vA, J) + b;
-		double lambda = -effectiveMass * deltaV;
+		// solve (dot(J,V) + bias + gamma*lambdaSum)
+		real deltaV = dot(vA, J) + bias + gamma*impulseSum;
+		real lambda = -effectiveMass * deltaV;
+		impulseSum += lambda;
+		appliedImpulse = std::abs(lambda);
 
-		dvec3 force = J*lambda;
+		rvec3 force = J*lambda;
 
 		body->ApplyLinearMomentum(force);
 	}
 
+	// XPBD: like DistanceConstraint::Project with compliance 1/stiffness
+	virtual void Project(real h)
+	{
+		const rvec3 d = p - body->position;
+		const real distance = length(d);
+		if (distance < 1e-12 || stiffness <= 0) return;
+
+		appliedImpulse = std::abs(projectPositional(body, rvec3(0), NULL, rvec3(0), d/distance, distance - L, h, 1./stiffness, damping));
+	}
+
 };
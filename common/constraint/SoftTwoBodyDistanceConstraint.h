@@ -3,7 +3,8 @@
 #include "constraint/Constraint.h"
 
 /* 
- * Enforces the distance between two rigidBody 
+ * Enforces the distance between two rigidBody, softened by stiffness and damping
+ * (implicit spring, stable at the normal timestep for stiff settings as well)
  * similar to p6: http://www.bulletphysics.com/ftp/pub/test/physics/papers/IterativeDynamics.pdf
  */
 class SoftTwoBodyDistanceConstraint : public Constraint
@@ -12,13 +13,25 @@ public:
 	/// introduce offset from body in local coordinates
 	RigidBody* bodyA;
 	RigidBody* bodyB;
-	double L;
+	real L;
+	real stiffness;
+	real damping;
 	/// offsets, replace them for correct behaviour
-	dvec3 rA = dvec3(0);
-	dvec3 rB = dvec3(0);
+	rvec3 rA = rvec3(0);
+	rvec3 rB = rvec3(0);
 
+private:
+	// cached by Prepare
+	rvec3 J1, J2, J3, J4;
+	real effectiveMass;
+	real bias;
+	real gamma;
+
+	accum impulseSum = 0; // accumulated over the iterations of a step, the softness depends on it
+
+public:
 	/// rAloc is offset of constraint in local coordinates of body A
-	SoftTwoBodyDistanceConstraint(RigidBody* bodyA_In, RigidBody* bodyB_In, vec3 rAloc = vec3(0,0,0), vec3 rBloc = vec3(0,0,0))
+	SoftTwoBodyDistanceConstraint(RigidBody* bodyA_In, RigidBody* bodyB_In, vec3 rAloc = vec3(0,0,0), vec3 rBloc = vec3(0,0,0), real stiffness = 100000, real damping = 50)
 	{
 		this->bodyA = bodyA_In;
 		this->bodyB = bodyB_In;
@@ -29,56 +42,74 @@ public:
 		this->rA = rAloc;
 		this->rB = rBloc;
 		this->L = length(bodyB->LocalToGlobal(rB) - bodyA->LocalToGlobal(rA)); // save initial distance
+		this->stiffness = stiffness;
+		this->damping = damping;
 	}
-	/// Constraint: 1/2((p2- p1)^2 - L^2)
-	virtual void Solve(double dt)
+
+	virtual RigidBody* GetBodyA() { return bodyA; }
+	virtual RigidBody* GetBodyB() { return bodyB; }
+
+	/// Constraint: |p2 - p1| - L
+	virtual void Prepare(real dt)
 	{
-		const dvec3 d = bodyB->position - bodyA->position;
+		impulseSum = 0;
+
+		const rvec3 pA = bodyA->LocalToGlobal(rA);
+		const rvec3 pB = bodyB->LocalToGlobal(rB);
+		const real distance = length(pB - pA);
+		const rvec3 n = distance > 0 ? (pB - pA)/distance : rvec3(0,1,0);
 		
 		// create J:
 		// J = (J1, J2, J3, J4)
-		/// TODO: do we need all factors ? Symmetric...
-		/// I think J2 and J4 are needed for angular momentum
-		const dvec3 J1 = - d;
-		const dvec3 J2 = -cross(bodyA->LocalToGlobal(rA) - bodyA->position, d);
-		const dvec3 J3 = d;
-		const dvec3 J4 = cross(bodyB->LocalToGlobal(rB) - bodyB->position, d);
-		
-		// get V
-		// (vA, omegaA, vB, omegaB)
-		const dvec3 vA = bodyA->velocity;
-		const dvec3 omegaA = bodyA->angularVelocity;
-		const dvec3 vB = bodyB->velocity;
-		const dvec3 omegaB = bodyB->angularVelocity;
-		
-		// soft parameter
-		// http://www.ode.org/ode-latest-userguide.html#sec_3_8_0
-		double CFM = 0.00001;
-		
-		// get m_c
-		const double effectiveMass = 1./( 
-									bodyA->GetEffectiveMassInverse(J1,J2) + 
-									bodyB->GetEffectiveMassInverse(J3,J4)
-									+ CFM/dt);
+		J1 = -n;
+		J2 = -cross(pA - bodyA->position, n);
+		J3 = n;
+		J4 = cross(pB - bodyB->position, n);
 		
 		int size = 10;
-		DebugRenderer::Instance()->AddDebugPoint(bodyA->LocalToGlobal(rA), dvec3(0,0.5,0.5), size);
-		DebugRenderer::Instance()->AddDebugPoint(bodyB->LocalToGlobal(rB), dvec3(0.5,0.5,0), size);
+		DebugRenderer::Instance()->AddDebugPoint(pA, rvec3(0,0.5,0.5), size);
+		DebugRenderer::Instance()->AddDebugPoint(pB, rvec3(0.5,0.5,0), size);
+
+		// soft parameters
+		real beta;
+		const real massInverse = bodyA->GetEffectiveMassInverse(J1,J2) + bodyB->GetEffectiveMassInverse(J3,J4);
+		if (!softParameters(stiffness, damping, dt, gamma, beta) || massInverse == 0)
+		{
+			effectiveMass = 0;
+			return;
+		}
+
+		// get m_c
+		effectiveMass = 1./(massInverse + gamma);
 		
-		// baumgarte stabilization
-		const double beta = 0.1;
-		//const double C = 1./2.*(length2(bodyA->LocalToGlobal(rA) - bodyB->LocalToGlobal(rB)) - std::pow(L,2));
-		const double C = (length(bodyA->LocalToGlobal(rA) - bodyB->LocalToGlobal(rB)) - L);
+		// position error, corrected as spring force
+		const real C = distance - L;
+		bias = beta/dt * C;
+	}
+
+	virtual void Solve(real dt)
+	{
+		appliedImpulse = 0;
+		if (effectiveMass == 0) return;
+
+		// get V
+		// (vA, omegaA, vB, omegaB)
+		const rvec3 vA = bodyA->velocity;
+		const rvec3 omegaA = bodyA->angularVelocity;
+		const rvec3 vB = bodyB->velocity;
+		const rvec3 omegaB = bodyB->angularVelocity;
 		
-		// solve (dot(J,V)+b)
-		const double deltaV = dot(vA, J1) + dot(omegaA, J2) + dot(vB, J3) + dot(omegaB, J4) + beta*C;
-		const double lambda = -effectiveMass * deltaV;
+		// solve (dot(J,V) + bias + gamma*lambdaSum)
+		const real deltaV = dot(vA, J1) + dot(omegaA, J2) + dot(vB, J3) + dot(omegaB, J4) + bias + gamma*impulseSum;
+		const real lambda = -effectiveMass * deltaV;
+		impulseSum += lambda;
+		appliedImpulse = std::abs(lambda);
 									
 		// get impulse
-		const dvec3 impulse1 = J1*lambda;
-		const dvec3 impulse2 = J2*lambda;
-		const dvec3 impulse3 = J3*lambda;
-		const dvec3 impulse4 = J4*lambda;
+		const rvec3 impulse1 = J1*lambda;
+		const rvec3 impulse2 = J2*lambda;
+		const rvec3 impulse3 = J3*lambda;
+		const rvec3 impulse4 = J4*lambda;
 
 		// apply forces to the two bodies
 		bodyA->ApplyLinearMomentum(impulse1);
@@ -87,4 +118,15 @@ public:
 		bodyB->ApplyLinearMomentum(impulse3);
 		bodyB->ApplyAngularMomentum(impulse4);
 	}
+
+	// XPBD: moves the two anchor points along their connection until the distance is L (compliance 1/stiffness)
+	virtual void Project(real h)
+	{
+		const rvec3 pA = bodyA->LocalToGlobal(rA);
+		const rvec3 pB = bodyB->LocalToGlobal(rB);
+		const real distance = length(pB - pA);
+		if (distance < 1e-12 || stiffness <= 0) return;
+
+		appliedImpulse = std::abs(projectPositional(bodyA, pA - bodyA->position, bodyB, pB - bodyB->position, (pB - pA)/distance, distance - L, h, 1./stiffness, damping));
+	}
 };
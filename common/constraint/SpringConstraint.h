@@ -2,8 +2,9 @@
 
 #include "constraint/Constraint.h"
 
-/* 
- * Enforces the distance between a rigidBody and a point
+/*
+ * Spring (with damper) between a rigidBody and a point, integrated implicitly as soft constraint
+ * so stiff springs stay stable at the normal timestep
  * similar to (slide 25): http://twvideo01.ubm-us.net/o1/vault/gdc09/slides/04-GDC09_Catto_Erin_Solver.pdf
  */
 class SpringConstraint : public Constraint
@@ -11,49 +12,85 @@ class SpringConstraint : public Constraint
 
 public:
 
-	dvec3 p;
+	rvec3 p;
 	RigidBody* body;
-	double L;
+	real L;
+	real stiffness;
+	real damping;
 
-	SpringConstraint(RigidBody* body, dvec3 point)
+private:
+	// cached by Prepare
+	rvec3 J;
+	real bias;
+	real gamma;
+	real effectiveMass;
+
+	accum impulseSum = 0; // accumulated over the iterations of a step, the softness depends on it
+
+public:
+	SpringConstraint(RigidBody* body, rvec3 point, real stiffness = 100, real damping = 1)
 	{
 		this->p = point;
 		this->body = body;
 		this->L = length(body->position - p); // save initial distance
+		this->stiffness = stiffness;
+		this->damping = damping;
 		this->body->SetSleepingEnabled(false);
 	}
 
-	virtual void Solve(double dt)
+	virtual RigidBody* GetBodyA() { return body; }
+
+	virtual void Prepare(real dt)
 	{
-		// get V
-		// (vA)
-		dvec3 vA = body->velocity;
+		impulseSum = 0;
 
 		// create J:
 		// (x/norm(x))
-		dvec3 J = normalize(body->position-p);
+		J = normalize(body->position-p);
 
-		// correct distance
-		//double b = 0.5* std::pow(length(body->position - p) - L, 2);
-		
-		double diff = length(body->position - p) - L;
-		double b = 0.5* std::pow(diff, 2);
+		real beta;
+		if (!softParameters(stiffness, damping, dt, gamma, beta) || body->inverseMass == 0)
+		{
+			effectiveMass = 0;
+			return;
+		}
 
-		//
-		//std::cout << b << std::endl;
+		// spring force as position error
+		real C = length(body->position - p) - L;
+		bias = beta/dt * C;
 
-		// effective mass
-		double effectiveMass = 1./(body->inverseMass);
+		// effective mass, softened
+		effectiveMass = 1./(body->inverseMass + gamma);
+	}
 
-		double C= 0.1;
+	virtual void Solve(real dt)
+	{
+		appliedImpulse = 0;
+		if (effectiveMass == 0) return;
 
-		// solve (dot(J,V)+b)
-		double deltaV =  C*b ;
-		double lambda = -effectiveMass * deltaV;
+		// get V
+		// (vA)
+		rvec3 vA = body->velocity;
 
-		dvec3 force = J*lambda;
+		// solve (dot(J,V) + bias + gamma*lambdaSum)
+		real deltaV = dot(vA, J) + bias + gamma*impulseSum;
+		real lambda = -effectiveMass * deltaV;
+		impulseSum += lambda;
+		appliedImpulse = std::abs(lambda);
+
+		rvec3 force = J*lambda;
 
 		body->ApplyLinearMomentum(force);
 	}
 
+	// XPBD: like DistanceConstraint::Project with compliance 1/stiffness
+	virtual void Project(real h)
+	{
+		const rvec3 d = p - body->position;
+		const real distance = length(d);
+		if (distance < 1e-12 || stiffness <= 0) return;
+
+		appliedImpulse = std::abs(projectPositional(body, rvec3(0), NULL, rvec3(0), d/distance, distance - L, h, 1./stiffness, damping));
+	}
+
 };
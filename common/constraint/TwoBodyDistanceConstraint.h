@@ -12,11 +12,18 @@ public:
 	/// introduce offset from body in local coordinates
 	RigidBody* bodyA;
 	RigidBody* bodyB;
-	double L;
+	real L;
 	/// offsets, replace them for correct behaviour
-	dvec3 rA = dvec3(0);
-	dvec3 rB = dvec3(0);
+	rvec3 rA = rvec3(0);
+	rvec3 rB = rvec3(0);
 
+private:
+	// cached by Prepare
+	rvec3 J1, J2, J3, J4;
+	real effectiveMass;
+	real bias;
+
+public:
 	/// rAloc is offset of constraint in local coordinates of body A
 	TwoBodyDistanceConstraint(RigidBody* bodyA_In, RigidBody* bodyB_In, vec3 rAloc = vec3(0,0,0), vec3 rBloc = vec3(0,0,0))
 	{
@@ -30,51 +37,84 @@ public:
 		this->rB = rBloc;
 		this->L = length(bodyB->LocalToGlobal(rB) - bodyA->LocalToGlobal(rA)); // save initial distance
 	}
+
+	virtual RigidBody* GetBodyA() { return bodyA; }
+	virtual RigidBody* GetBodyB() { return bodyB; }
+
 	/// Constraint: 1/2((p2- p1)^2 - L^2)
-	virtual void Solve(double dt)
+	virtual void Prepare(real dt)
 	{
-		const dvec3 d = bodyB->position - bodyA->position;
+		const rvec3 d = bodyB->position - bodyA->position;
 		
 		// create J:
 		// J = (J1, J2, J3, J4)
 		/// TODO: do we need all factors ? Symmetric...
 		/// I think J2 and J4 are needed for angular momentum
-		const dvec3 J1 = - d;
-		const dvec3 J2 = -cross(bodyA->LocalToGlobal(rA) - bodyA->position, d);
-		const dvec3 J3 = d;
-		const dvec3 J4 = cross(bodyB->LocalToGlobal(rB) - bodyB->position, d);
-		
-		// get V
-		// (vA, omegaA, vB, omegaB)
-		const dvec3 vA = bodyA->velocity;
-		const dvec3 omegaA = bodyA->angularVelocity;
-		const dvec3 vB = bodyB->velocity;
-		const dvec3 omegaB = bodyB->angularVelocity;
+		J1 = - d;
+		J2 = -cross(bodyA->LocalToGlobal(rA) - bodyA->position, d);
+		J3 = d;
+		J4 = cross(bodyB->LocalToGlobal(rB) - bodyB->position, d);
 		
 		// get m_c
-		const double effectiveMass = 1./( 
+		effectiveMass = 1./( 
 									bodyA->GetEffectiveMassInverse(J1,J2) + 
 									bodyB->GetEffectiveMassInverse(J3,J4)
 									);
 		
 		int size = 10;
-		DebugRenderer::Instance()->AddDebugPoint(bodyA->LocalToGlobal(rA), dvec3(0,0.5,0.5), size);
-		DebugRenderer::Instance()->AddDebugPoint(bodyB->LocalToGlobal(rB), dvec3(0.5,0.5,0), size);
+		DebugRenderer::Instance()->AddDebugPoint(bodyA->LocalToGlobal(rA), rvec3(0,0.5,0.5), size);
+		DebugRenderer::Instance()->AddDebugPoint(bodyB->LocalToGlobal(rB), rvec3(0.5,0.5,0), size);
 		
 		// baumgarte stabilization
-		const double beta = 0.1;
-		//const double C = 1./2.*(length2(bodyA->LocalToGlobal(rA) - bodyB->LocalToGlobal(rB)) - std::pow(L,2));
-		const double C = (length(bodyA->LocalToGlobal(rA) - bodyB->LocalToGlobal(rB)) - L);
+		const real beta = 0.1;
+		//const real C = 1./2.*(length2(bodyA->LocalToGlobal(rA) - bodyB->LocalToGlobal(rB)) - std::pow(L,2));
+		const real C = (length(bodyA->LocalToGlobal(rA) - bodyB->LocalToGlobal(rB)) - L);
+		bias = beta*C;
+	}
+
+	virtual void Solve(real dt)
+	{
+		solve(true);
+	}
+
+	// iteration after the positions were integrated (temporal gauss seidel): prepared jacobians, no baumgarte bias
+	virtual void Relax(real dt)
+	{
+		solve(false);
+	}
+
+	// XPBD: moves the two anchor points along their connection until the distance is L
+	virtual void Project(real h)
+	{
+		const rvec3 pA = bodyA->LocalToGlobal(rA);
+		const rvec3 pB = bodyB->LocalToGlobal(rB);
+		const real distance = length(pB - pA);
+		if (distance < 1e-12) return;
+
+		appliedImpulse = std::abs(projectPositional(bodyA, pA - bodyA->position, bodyB, pB - bodyB->position, (pB - pA)/distance, distance - L, h));
+	}
+
+private:
+
+	void solve(bool withBias)
+	{
+		// get V
+		// (vA, omegaA, vB, omegaB)
+		const rvec3 vA = bodyA->velocity;
+		const rvec3 omegaA = bodyA->angularVelocity;
+		const rvec3 vB = bodyB->velocity;
+		const rvec3 omegaB = bodyB->angularVelocity;
 		
 		// solve (dot(J,V)+b)
-		const double deltaV = dot(vA, J1) + dot(omegaA, J2) + dot(vB, J3) + dot(omegaB, J4) + beta*C;
-		const double lambda = -effectiveMass * deltaV;
+		const real deltaV = dot(vA, J1) + dot(omegaA, J2) + dot(vB, J3) + dot(omegaB, J4) + (withBias ? bias : 0);
+		const real lambda = -effectiveMass * deltaV;
+		appliedImpulse = std::abs(lambda);
 									
 		// get impulse
-		const dvec3 impulse1 = J1*lambda;
-		const dvec3 impulse2 = J2*lambda;
-		const dvec3 impulse3 = J3*lambda;
-		const dvec3 impulse4 = J4*lambda;
+		const rvec3 impulse1 = J1*lambda;
+		const rvec3 impulse2 = J2*lambda;
+		const rvec3 impulse3 = J3*lambda;
+		const rvec3 impulse4 = J4*lambda;
 
 		// apply forces to the two bodies
 		bodyA->ApplyLinearMomentum(impulse1);
@@ -373,7 +373,7 @@ public:
 				 //stone->GetRigidBody()->ApplyLinearMomentum(dvec3(0.1,0,0)); // push it out of equilibrium
 				 scene->AddEntity(stone);
 
-				 DistanceConstraint* dst = new DistanceConstraint(stone->GetRigidBody(), midpoint);
+				 DistanceConstraint dst(stone->GetRigidBody(), midpoint);
 				 scene->GetPhysicManager()->AddConstraint(dst);
 			 }
 		}
@@ -392,7 +392,7 @@ public:
 			stone2->SetScale(vec3(0.1));
 			scene->AddEntity(stone2);
 
-			DistanceConstraint* dst = new DistanceConstraint(stone->GetRigidBody(), midpoint);
+			DistanceConstraint dst(stone->GetRigidBody(), midpoint);
 			scene->GetPhysicManager()->AddConstraint(dst);
 		}*/
 		double epsilon = 0.01;
@@ -407,7 +407,7 @@ public:
 			//~ stone->GetRigidBody()->ApplyLinearMomentum(dvec3(0,-0.5,0));
 			//~ scene->AddEntity(stone);
 			
-			//~ SoftDistanceConstraint* dst = new SoftDistanceConstraint(stone->GetRigidBody(), midpoint);
+			//~ SoftDistanceConstraint dst(stone->GetRigidBody(), midpoint);
 			//~ scene->GetPhysicManager()->AddConstraint(dst);
 			
 
@@ -422,7 +422,7 @@ public:
 			stone->SetScale(vec3(0.1));
 			stone->GetRigidBody()->ApplyLinearMomentum(dvec3(0,-0.2,0)); // push it out of equilibrium
 			scene->AddEntity(stone);
-			SpringConstraint* dst = new SpringConstraint(stone->GetRigidBody(), midpoint);
+			SpringConstraint dst(stone->GetRigidBody(), midpoint);
 			scene->GetPhysicManager()->AddConstraint(dst);
 			
 		}
@@ -439,10 +439,10 @@ public:
 			RigidBodyModel* stone2 = new RigidBodyModel(MeshGenerator::CreateSphere(), midpoint + vec3(0.5,1,0));
 			stone2->SetScale(vec3(0.1));
 			scene->AddEntity(stone2);
-			DistanceConstraint* dst = new DistanceConstraint(stone->GetRigidBody(), midpoint);
+			DistanceConstraint dst(stone->GetRigidBody(), midpoint);
 			scene->GetPhysicManager()->AddConstraint(dst);
 			
-			TwoBodyDistanceConstraint* dst2 = new TwoBodyDistanceConstraint(stone->GetRigidBody(), stone2->GetRigidBody());
+			TwoBodyDistanceConstraint dst2(stone->GetRigidBody(), stone2->GetRigidBody());
 			scene->GetPhysicManager()->AddConstraint(dst2);*/
 		}
 		
@@ -468,7 +468,7 @@ public:
 				newBox->SetRotation(vec3(0,0,0));
 				scene->AddEntity(newBox);
 				
-				TwoBodyDistanceConstraint* dst = new TwoBodyDistanceConstraint(newBox->GetRigidBody(), oldBox->GetRigidBody(), vec3(0,0.5,0), vec3(0,-0.5,0));
+				TwoBodyDistanceConstraint dst(newBox->GetRigidBody(), oldBox->GetRigidBody(), vec3(0,0.5,0), vec3(0,-0.5,0));
 				scene->GetPhysicManager()->AddConstraint(dst);
 				oldBox = newBox;
 			}
@@ -497,7 +497,7 @@ public:
 				scene->AddEntity(newBox);
 				
 				vec3 jointPos = pos + 0.5f*dst;
-				BallJointConstraint* dst = new BallJointConstraint(newBox->GetRigidBody(), oldBox->GetRigidBody(), jointPos);
+				BallJointConstraint dst(newBox->GetRigidBody(), oldBox->GetRigidBody(), jointPos);
 				scene->GetPhysicManager()->AddConstraint(dst);
 				oldBox = newBox;
 			}
@@ -519,7 +519,7 @@ public:
 			//~ box2->SetRotation(vec3(0,0,0));
 			scene->AddEntity(box2);
 			
-			HingeConstraint* dst = new HingeConstraint(box1->GetRigidBody(), box2->GetRigidBody(), vec3(0,0,1), vec3(2.5,1,0));
+			HingeConstraint dst(box1->GetRigidBody(), box2->GetRigidBody(), vec3(0,0,1), vec3(2.5,1,0));
 			scene->GetPhysicManager()->AddConstraint(dst);
 		}
 		
@@ -539,7 +539,7 @@ public:
 			box2->SetRotation(radians(vec3(0,0,90)));
 			scene->AddEntity(box2);
 			
-			HingeConstraint* dst = new HingeConstraint(box1->GetRigidBody(), box2->GetRigidBody(), vec3(0,0,1), position - vec3(0,.5,0));
+			HingeConstraint dst(box1->GetRigidBody(), box2->GetRigidBody(), vec3(0,0,1), position - vec3(0,.5,0));
 			scene->GetPhysicManager()->AddConstraint(dst);
 		}
 	
@@ -604,7 +604,7 @@ public:
 				newBox->SetRotation(vec3(0,0,0));
 				scene->AddEntity(newBox);
 				
-				BallJointConstraint* dst = new BallJointConstraint(newBox->GetRigidBody(), oldBox->GetRigidBody(), fixPoint - dist + vec3(0,L/2.,0));
+				BallJointConstraint dst(newBox->GetRigidBody(), oldBox->GetRigidBody(), fixPoint - dist + vec3(0,L/2.,0));
 				scene->GetPhysicManager()->AddConstraint(dst);
 				oldBox = newBox;
 			}
@@ -618,7 +618,7 @@ public:
 			ball->SetRotation(vec3(0,0,0));
 			scene->AddEntity(ball);
 			
-			BallJointConstraint* dst = new BallJointConstraint(ball->GetRigidBody(), oldBox->GetRigidBody(), fixPoint - dist + vec3(0,(L+ballSize)/2.,0));
+			BallJointConstraint dst(ball->GetRigidBody(), oldBox->GetRigidBody(), fixPoint - dist + vec3(0,(L+ballSize)/2.,0));
 			scene->GetPhysicManager()->AddConstraint(dst);
 		}
 
@@ -649,6 +649,8 @@ public:
 			double dy = dx;
 			const int x_size = 10;
 			const int y_size = 10;
+			const double stiffness = 2000; // implicit springs, no extra substeps needed
+			const double damping = 5;
 			RigidBodyModel **RidgidBodyArray = new RigidBodyModel*[x_size*y_size];
 			
 			for(int x = 0; x < x_size; ++x)
@@ -671,7 +673,7 @@ public:
 				for(int y = 1; y < y_size; ++y)
 				{
 					RigidBodyModel* next = RidgidBodyArray[y*x_size+x];
-					SoftTwoBodyDistanceConstraint* dst = new SoftTwoBodyDistanceConstraint(last->GetRigidBody(), next->GetRigidBody());
+					SoftTwoBodyDistanceConstraint dst(last->GetRigidBody(), next->GetRigidBody(), vec3(0), vec3(0), stiffness, damping);
 					scene->GetPhysicManager()->AddConstraint(dst);
 					last = next;
 				}
@@ -682,7 +684,7 @@ public:
 				for(int x = 1; x < x_size; ++x)
 				{
 					RigidBodyModel* next = RidgidBodyArray[y*x_size+x];
-					SoftTwoBodyDistanceConstraint* dst = new SoftTwoBodyDistanceConstraint(last->GetRigidBody(), next->GetRigidBody());
+					SoftTwoBodyDistanceConstraint dst(last->GetRigidBody(), next->GetRigidBody(), vec3(0), vec3(0), stiffness, damping);
 					scene->GetPhysicManager()->AddConstraint(dst);
 					last  = next;
 				}
@@ -791,7 +793,7 @@ public:
 			stone->GetRigidBody()->ApplyLinearMomentum(dvec3(4.4,0,0)); // push it out of equilibrium
 			scene->AddEntity(stone);
 
-			DistanceConstraint* dst = new DistanceConstraint(stone->GetRigidBody(), midpoint);
+			DistanceConstraint dst(stone->GetRigidBody(), midpoint);
 			scene->GetPhysicManager()->AddConstraint(dst);
 		}
 
@@ -1415,7 +1417,7 @@ public:
 			BottomBox->SetRotation(radians(vec3(45.f,0.f,35.26439)));
 			scene->AddEntity(BottomBox);
 			
-			BallJointConstraint* constraint = new BallJointConstraint(TopBox->GetRigidBody(), BottomBox->GetRigidBody(), joint);
+			BallJointConstraint constraint(TopBox->GetRigidBody(), BottomBox->GetRigidBody(), joint);
 			scene->GetPhysicManager()->AddConstraint(constraint);
 			
 			Model* center = new Model(MeshGenerator::CreateSphere(vec3(1,0,0)), joint);
@@ -1442,7 +1444,7 @@ public:
 				BottomBox->SetRotation(radians(vec3(45.f,0.f,35.26439)));
 				scene->AddEntity(BottomBox);
 				
-				BallJointConstraint* constraint = new BallJointConstraint(TopBox->GetRigidBody(), BottomBox->GetRigidBody(), joint);
+				BallJointConstraint constraint(TopBox->GetRigidBody(), BottomBox->GetRigidBody(), joint);
 				scene->GetPhysicManager()->AddConstraint(constraint);
 			
 				joint = joint - offset-offset;
@@ -1476,7 +1478,7 @@ public:
 				scene->AddEntity(newBox);
 				
 				vec3 jointPos = pos + 0.5f*dst;
-				BallJointConstraint* constraint = new BallJointConstraint(newBox->GetRigidBody(), oldBox->GetRigidBody(), jointPos);
+				BallJointConstraint constraint(newBox->GetRigidBody(), oldBox->GetRigidBody(), jointPos);
 				scene->GetPhysicManager()->AddConstraint(constraint);
 				oldBox = newBox;
 			}
@@ -1519,7 +1521,7 @@ public:
 			
 			vec3 axisPos = position + dist/2.f;
 			vec3 axis(0,0,1);
-			HingeConstraint* constraint = new HingeConstraint(box1->GetRigidBody(), box2->GetRigidBody(), axis, axisPos);
+			HingeConstraint constraint(box1->GetRigidBody(), box2->GetRigidBody(), axis, axisPos);
 			scene->GetPhysicManager()->AddConstraint(constraint);
 		}
 		
@@ -1540,7 +1542,7 @@ public:
 			
 			vec3 axisPos = position + dist/2.f;
 			vec3 axis(1,0,0);
-			HingeConstraint* dst = new HingeConstraint(box1->GetRigidBody(), box2->GetRigidBody(), axis, axisPos);
+			HingeConstraint dst(box1->GetRigidBody(), box2->GetRigidBody(), axis, axisPos);
 			scene->GetPhysicManager()->AddConstraint(dst);
 		}
 		
@@ -1574,7 +1576,7 @@ public:
 			stone->SetScale(vec3(0.1));
 			scene->AddEntity(stone);
 			
-			DistanceConstraint* dst = new DistanceConstraint(stone->GetRigidBody(), midpoint);
+			DistanceConstraint dst(stone->GetRigidBody(), midpoint);
 			scene->GetPhysicManager()->AddConstraint(dst);
 		}
 		// double pendulum
@@ -1591,10 +1593,10 @@ public:
 			RigidBodyModel* stone2 = new RigidBodyModel(MeshGenerator::CreateSphere(), midpoint + vec3(0,1,0.5));
 			stone2->SetScale(vec3(0.1));
 			scene->AddEntity(stone2);
-			DistanceConstraint* dst = new DistanceConstraint(stone->GetRigidBody(), midpoint);
+			DistanceConstraint dst(stone->GetRigidBody(), midpoint);
 			scene->GetPhysicManager()->AddConstraint(dst);
 			
-			TwoBodyDistanceConstraint* dst2 = new TwoBodyDistanceConstraint(stone->GetRigidBody(), stone2->GetRigidBody());
+			TwoBodyDistanceConstraint dst2(stone->GetRigidBody(), stone2->GetRigidBody());
 			scene->GetPhysicManager()->AddConstraint(dst2);
 		}
 		// impulse pendulum
@@ -1620,7 +1622,7 @@ public:
 				stone->SetScale(vec3(radius));
 				scene->AddEntity(stone);
 
-				DistanceConstraint* dst = new DistanceConstraint(stone->GetRigidBody(), midpoint);
+				DistanceConstraint dst(stone->GetRigidBody(), midpoint);
 				scene->GetPhysicManager()->AddConstraint(dst);
 			}	
 		}
@@ -1636,7 +1638,7 @@ public:
 			stone->SetScale(vec3(0.1));
 			stone->GetRigidBody()->ApplyLinearMomentum(dvec3(0,-0.2,0)); // push it out of equilibrium
 			scene->AddEntity(stone);
-			SpringConstraint* dst = new SpringConstraint(stone->GetRigidBody(), midpoint);
+			SpringConstraint dst(stone->GetRigidBody(), midpoint);
 			scene->GetPhysicManager()->AddConstraint(dst);
 		}
 		
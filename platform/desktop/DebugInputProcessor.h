@@ -20,6 +20,8 @@ private:
 	bool debugRendering = true;
 	bool fullscreen = false;
 	DesktopWindowManager* windowManager;
+	ReplayRecorder* recorder = NULL;
+	SharedTransformExporter* exporter = NULL;
 
 public:
 	
@@ -30,6 +32,12 @@ public:
 		if (debugRendering) DebugRenderer::Instance()->Enable();
 	}	
 
+	~DebugInputProcessor()
+	{
+		stopRecording();
+		stopExport();
+	}
+
 	void OnKeyInput(const bool* keys, GLfloat dt) 
 	{
 		if (keys[GLFW_KEY_F1] || keys[GLFW_KEY_B]) glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
@@ -61,6 +69,66 @@ public:
 
 			fullscreen = !fullscreen;
 		}
+		// switch the constraint solver (compare iterations/residual in the timing output)
+		if (key == GLFW_KEY_G)
+		{
+			PhysicManager* physicManager = scene->GetPhysicManager();
+			if (physicManager->GetConstraintSolverType() == ProjectedGaussSeidel)
+			{
+				physicManager->SetConstraintSolverType(ConjugateGaussSeidel);
+				std::cout << "constraint solver: conjugate gauss seidel (NNCG)" << std::endl;
+			}
+			else
+			{
+				physicManager->SetConstraintSolverType(ProjectedGaussSeidel);
+				std::cout << "constraint solver: PGS" << std::endl;
+			}
+		}
+		// switch between the impulse based and the position based (XPBD) stepping
+		if (key == GLFW_KEY_X)
+		{
+			PhysicManager* physicManager = scene->GetPhysicManager();
+			if (physicManager->GetSteppingMode() != PositionBasedDynamics)
+			{
+				physicManager->SetSteppingMode(PositionBasedDynamics);
+				std::cout << "stepping: XPBD" << std::endl;
+			}
+			else
+			{
+				physicManager->SetSteppingMode(SequentialImpulses);
+				std::cout << "stepping: sequential impulses" << std::endl;
+			}
+		}
+		// record the simulation into a replay file (see ReplayRecorder.h), with the contacts if debug rendering is on
+		if (key == GLFW_KEY_C)
+		{
+			if (recorder == NULL)
+			{
+				recorder = new ReplayRecorder("replay.phr", debugRendering);
+				scene->GetPhysicManager()->SetReplayRecorder(recorder);
+				std::cout << "recording: replay.phr" << std::endl;
+			}
+			else
+			{
+				std::cout << "recorded " << recorder->GetFrameCount() << " frames" << std::endl;
+				stopRecording();
+			}
+		}
+		// publish the transforms to shared memory (see SharedTransformReader.h)
+		if (key == GLFW_KEY_V)
+		{
+			if (exporter == NULL)
+			{
+				exporter = new SharedTransformExporter();
+				scene->GetPhysicManager()->SetTransformExporter(exporter);
+				std::cout << "transform export: " << SHARED_TRANSFORM_NAME << std::endl;
+			}
+			else
+			{
+				std::cout << "exported " << exporter->GetStepCount() << " steps" << std::endl;
+				stopExport();
+			}
+		}
 		if (key == GLFW_KEY_SPACE)
 		{
 			// ball
@@ -69,6 +137,12 @@ public:
 			ball->GetRigidBody()->ApplyLinearMomentum(5.0f * scene->GetCamera()->GetDirection());
 			scene->AddEntity(ball);
 		}
+		// explosion in front of the camera
+		if (key == GLFW_KEY_R)
+		{
+			vec3 center = scene->GetCamera()->GetPosition() + 3.f * scene->GetCamera()->GetDirection();
+			scene->GetPhysicManager()->AddForceGenerator(new ExplosionGenerator(rvec3(center), 2, 3));
+		}
 		// bombardement
 		if (key == GLFW_KEY_T)
 		{
@@ -134,7 +208,7 @@ public:
 				{
 					std::cout << i << std::endl;
 					vec3 jointPos = pos - shift/2.f;
-					BallJointConstraint* constraint = new BallJointConstraint(newCylinder->GetRigidBody(), oldCylinder->GetRigidBody(), jointPos);
+					BallJointConstraint constraint(newCylinder->GetRigidBody(), oldCylinder->GetRigidBody(), jointPos);
 					scene->GetPhysicManager()->AddConstraint(constraint);
 				}
 				oldCylinder = newCylinder;
@@ -142,6 +216,22 @@ public:
 		}
 	}
 
+	void stopRecording()
+	{
+		if (recorder == NULL) return;
+		scene->GetPhysicManager()->SetReplayRecorder(NULL);
+		delete recorder;
+		recorder = NULL;
+	}
+
+	void stopExport()
+	{
+		if (exporter == NULL) return;
+		scene->GetPhysicManager()->SetTransformExporter(NULL);
+		delete exporter;
+		exporter = NULL;
+	}
+
 	void OnMouseMoved(GLfloat xpos, GLfloat ypos, GLfloat xoffset, GLfloat yoffset)
 	{
 	}
@@ -11,6 +11,8 @@
 class InputProcessor
 {
 public:
+	virtual ~InputProcessor() {}
+
 	virtual void OnMouseMoved(GLfloat xpos, GLfloat ypos, GLfloat xoffset, GLfloat yoffset) {}
 	virtual void OnScrollInput(GLfloat xoffset, GLfloat yoffset) {}
 	virtual void OnKeyInput(const bool* keys, GLfloat dt) {}
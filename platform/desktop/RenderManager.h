@@ -41,6 +41,12 @@ private:
 	GLuint depthMapFBO;
 	GLuint depthMap;
 
+	// cached depth map of the static geometry, copied into the shadow depth map every frame
+	GLuint staticDepthMapFBO;
+	GLuint staticDepthMap;
+	bool staticDepthMapValid = false;
+	mat4 staticLightSpaceMatrix; // the static depth map was rendered with
+
 public:
 	RenderManager(DesktopWindowManager* windowManager, Scene* scene) : 
 			colorShader("colorVertexShader.txt", "colorFragmentShader.txt"), 
@@ -61,14 +67,42 @@ public:
 
 		depthShader.Use();
 
-		// use depth map framebuffer
 		glViewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
-		glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
-		glClear(GL_DEPTH_BUFFER_BIT);
 		glCullFace(GL_FRONT);
 
+		// only the models inside the volume of the light cast shadows into the depth map
+		mat4 lightSpaceMatrix = scene->GetLight()->GetLightSpaceMatrix();
+		Frustum lightFrustum(lightSpaceMatrix);
+
+		// the static geometry is only rendered if it or the light changed
+		Model::SetCullFrustum(&lightFrustum, 2);
+		Model::SetDrawLayer(StaticLayer, false);
+		scene->Draw(depthShader);
+
+		if (!staticDepthMapValid || Model::StaticLayerChanged() || !(lightSpaceMatrix == staticLightSpaceMatrix))
+		{
+			glBindFramebuffer(GL_FRAMEBUFFER, staticDepthMapFBO);
+			glClear(GL_DEPTH_BUFFER_BIT);
+			Model::SetDrawLayer(StaticLayer);
+			renderScene(depthShader);
+
+			staticDepthMapValid = true;
+			staticLightSpaceMatrix = lightSpaceMatrix;
+		}
+		Model::ResetStaticLayerChanged();
+
+		// copy the static depth map and render the dynamic geometry on top
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, staticDepthMapFBO);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, depthMapFBO);
+		glBlitFramebuffer(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT, 0, 0, SHADOW_WIDTH, SHADOW_HEIGHT, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+		glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
+
+		Model::SetCullFrustum(&lightFrustum, 0);
+		Model::SetDrawLayer(DynamicLayer);
 		renderScene(depthShader);
 
+		Model::SetDrawLayer(AllLayers);
+
 
 		//2nd pass: render with shadow mapping
 
@@ -87,8 +121,14 @@ public:
 		glActiveTexture(GL_TEXTURE0);
 		glBindTexture(GL_TEXTURE_2D, depthMap); 
 
+		Camera* camera = scene->GetCamera();
+		Frustum cameraFrustum(camera->GetProjectionMatrix() * camera->GetViewMatrix());
+		Model::SetCullFrustum(&cameraFrustum, 1);
+
 		renderScene(colorShader);
 
+		Model::SetCullFrustum(NULL);
+
 		// debug pass
 		debugShader.Use();
 		renderDebugInformation(debugShader);
@@ -155,12 +195,25 @@ private:
 		glEnable(GL_CULL_FACE);  
 		glFrontFace(GL_CCW);  
 
+		// shadow depth map and the static one (same format, s.t. it can be blitted)
+		initDepthMap(depthMapFBO, depthMap);
+		initDepthMap(staticDepthMapFBO, staticDepthMap);
+
+
+		// multi sampling
+		glfwWindowHint(GLFW_SAMPLES, 16);
+		glEnable(GL_MULTISAMPLE);  
+		
+	}
+
+	void initDepthMap(GLuint& fbo, GLuint& texture)
+	{
 		// framebuffer for shadow depth map
-		glGenFramebuffers(1, &depthMapFBO);  
+		glGenFramebuffers(1, &fbo);  
 
 		// texture for shadow depth map
-		glGenTextures(1, &depthMap);
-		glBindTexture(GL_TEXTURE_2D, depthMap);
+		glGenTextures(1, &texture);
+		glBindTexture(GL_TEXTURE_2D, texture);
 		glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, 
 					 SHADOW_WIDTH, SHADOW_HEIGHT, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
@@ -174,17 +227,11 @@ private:
 
 
 		// bind shadow depth buffer to texture => the depth buffer will be rendered to the texture
-		glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthMap, 0);
+		glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, texture, 0);
 		glDrawBuffer(GL_NONE);
 		glReadBuffer(GL_NONE);
 		glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-
-		// multi sampling
-		glfwWindowHint(GLFW_SAMPLES, 16);
-		glEnable(GL_MULTISAMPLE);  
-		
 	}
 };
 
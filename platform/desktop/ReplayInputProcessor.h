@@ -0,0 +1,63 @@
+/*
+ * Playback control of the replay viewer
+ */
+#pragma once
+
+#include <GL/glew.h>
+
+#include "InputManager.h"
+#include "ReplayPlayer.h"
+
+class ReplayInputProcessor : public InputProcessor
+{
+
+private:
+	ReplayPlayer* player;
+	bool showContacts = false;
+
+public:
+
+	ReplayInputProcessor(ReplayPlayer* player)
+	{
+		this->player = player;
+	}
+
+	void OnKeyDown(int key)
+	{
+		bool playback = true;
+
+		// pause / play
+		if (key == GLFW_KEY_P || key == GLFW_KEY_SPACE) player->TogglePlaying();
+
+		// single frames (pauses)
+		else if (key == GLFW_KEY_RIGHT) player->Step(1);
+		else if (key == GLFW_KEY_LEFT) player->Step(-1);
+
+		// seek
+		else if (key == GLFW_KEY_UP) player->SeekRelative(1);
+		else if (key == GLFW_KEY_DOWN) player->SeekRelative(-1);
+		else if (key == GLFW_KEY_PAGE_UP) player->SeekRelative(10);
+		else if (key == GLFW_KEY_PAGE_DOWN) player->SeekRelative(-10);
+		else if (key == GLFW_KEY_HOME) player->SeekFrame(0);
+		else if (key == GLFW_KEY_END) player->SeekFrame(player->GetFrameCount() - 1);
+
+		// playback speed
+		else if (key == GLFW_KEY_KP_ADD || key == GLFW_KEY_EQUAL) player->SetSpeed(player->GetSpeed() * 2);
+		else if (key == GLFW_KEY_KP_SUBTRACT || key == GLFW_KEY_MINUS) player->SetSpeed(player->GetSpeed() / 2);
+		else playback = false;
+
+		// recorded contacts (as debug points)
+		if (key == GLFW_KEY_O)
+		{
+			if (!showContacts) DebugRenderer::Instance()->Enable();
+			else DebugRenderer::Instance()->Disable();
+			showContacts = !showContacts;
+		}
+
+		// status only after a playback key (not for the camera and the other keys)
+		if (playback)
+		{
+			std::cout << "frame " << player->GetFrame() << "/" << player->GetFrameCount() << " speed " << player->GetSpeed() << std::endl;
+		}
+	}
+};
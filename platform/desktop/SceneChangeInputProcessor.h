@@ -265,7 +265,7 @@ private:
 		polygon->SetScale(vec3(0.6,1,0.6));
 		polygon->SetRotation(radians(vec3(90,0,0)));
 		entity->AddChild(polygon);
-		HingeConstraint* dst1 = new HingeConstraint(box->GetRigidBody(), polygon->GetRigidBody(), vec3(0,0,0.3), position);
+		HingeConstraint dst1(box->GetRigidBody(), polygon->GetRigidBody(), vec3(0,0,0.3), position);
 		scene->GetPhysicManager()->AddConstraint(dst1);
 		// sticks around polygon
 		double L_ = -1.2;
@@ -277,7 +277,7 @@ private:
 			entity->AddChild(stick);
 			vec3 axisPos = position + radius;
 			vec3 axis(0,0,1);
-			HingeConstraint* stick_dst = new HingeConstraint(polygon->GetRigidBody(), stick->GetRigidBody(), axis, axisPos);
+			HingeConstraint stick_dst(polygon->GetRigidBody(), stick->GetRigidBody(), axis, axisPos);
 			scene->GetPhysicManager()->AddConstraint(stick_dst);
 		}
 
@@ -288,7 +288,7 @@ private:
 		entity->AddChild(blockade);
 		vec3 axisPos = position + distance/2.f;
 		vec3 axis(0,0,1);
-		HingeConstraint* dst = new HingeConstraint(polygon->GetRigidBody(), blockade->GetRigidBody(), axis, axisPos);
+		HingeConstraint dst(polygon->GetRigidBody(), blockade->GetRigidBody(), axis, axisPos);
 		scene->GetPhysicManager()->AddConstraint(dst);
 
 		// lane above polygon, with balls
@@ -698,6 +698,10 @@ private:
 	void createCatapultScene()
 	{
 		scene->Clear();
+
+		// speculative contacts prevent the projectile from tunneling with less substeps
+		scene->GetPhysicManager()->SetSpeculativeContacts(true);
+		scene->GetPhysicManager()->SetTimestepDivider(2);
 		
 		// add ramp
 		RigidBodyModel* ramp = new RigidBodyModel(MeshGenerator::CreateBox(), vec3(0, 1.15,0));
@@ -932,7 +936,7 @@ private:
 			BottomBox->SetRotation(radians(vec3(45.f,0.f,35.26439)));
 			scene->AddEntity(BottomBox);
 			
-			BallJointConstraint* constraint = new BallJointConstraint(TopBox->GetRigidBody(), BottomBox->GetRigidBody(), joint);
+			BallJointConstraint constraint(TopBox->GetRigidBody(), BottomBox->GetRigidBody(), joint);
 			scene->GetPhysicManager()->AddConstraint(constraint);
 			
 			Model* center = new Model(MeshGenerator::CreateSphere(vec3(1,0,0)), joint);
@@ -959,7 +963,7 @@ private:
 				BottomBox->SetRotation(radians(vec3(45.f,0.f,35.26439)));
 				scene->AddEntity(BottomBox);
 				
-				BallJointConstraint* constraint = new BallJointConstraint(TopBox->GetRigidBody(), BottomBox->GetRigidBody(), joint);
+				BallJointConstraint constraint(TopBox->GetRigidBody(), BottomBox->GetRigidBody(), joint);
 				scene->GetPhysicManager()->AddConstraint(constraint);
 			
 				joint = joint - offset-offset;
@@ -993,7 +997,7 @@ private:
 				scene->AddEntity(newBox);
 				
 				vec3 jointPos = pos + 0.5f*dst;
-				BallJointConstraint* constraint = new BallJointConstraint(newBox->GetRigidBody(), oldBox->GetRigidBody(), jointPos);
+				BallJointConstraint constraint(newBox->GetRigidBody(), oldBox->GetRigidBody(), jointPos);
 				scene->GetPhysicManager()->AddConstraint(constraint);
 				oldBox = newBox;
 			}
@@ -1040,7 +1044,7 @@ private:
 			
 			vec3 axisPos = position + dist/2.f;
 			vec3 axis(0,0,1);
-			HingeConstraint* constraint = new HingeConstraint(box1->GetRigidBody(), box2->GetRigidBody(), axis, axisPos);
+			HingeConstraint constraint(box1->GetRigidBody(), box2->GetRigidBody(), axis, axisPos);
 			scene->GetPhysicManager()->AddConstraint(constraint);
 		}
 		
@@ -1061,7 +1065,7 @@ private:
 			
 			vec3 axisPos = position + dist/2.f;
 			vec3 axis(1,0,0);
-			HingeConstraint* dst = new HingeConstraint(box1->GetRigidBody(), box2->GetRigidBody(), axis, axisPos);
+			HingeConstraint dst(box1->GetRigidBody(), box2->GetRigidBody(), axis, axisPos);
 			scene->GetPhysicManager()->AddConstraint(dst);
 		}
 		// blue gearwheel
@@ -1081,7 +1085,7 @@ private:
 			polygon->SetScale(vec3(radius,0.2,radius));
 			polygon->SetRotation(radians(vec3(90,0,0)));
 			scene->AddEntity(polygon);
-			HingeConstraint* dst = new HingeConstraint(box->GetRigidBody(), polygon->GetRigidBody(), vec3(0,0,0.3), position);
+			HingeConstraint dst(box->GetRigidBody(), polygon->GetRigidBody(), vec3(0,0,0.3), position);
 			scene->GetPhysicManager()->AddConstraint(dst);
 			// sticks around polygon
 			double L_ = -radius-0.06;
@@ -1095,7 +1099,7 @@ private:
 				scene->AddEntity(stick);
 				vec3 axisPos = position + radius;
 				vec3 axis(0,0,1);
-				HingeConstraint* stick_dst = new HingeConstraint(polygon->GetRigidBody(), stick->GetRigidBody(), axis, axisPos);
+				HingeConstraint stick_dst(polygon->GetRigidBody(), stick->GetRigidBody(), axis, axisPos);
 				scene->GetPhysicManager()->AddConstraint(stick_dst);
 			}
 			
@@ -1106,7 +1110,7 @@ private:
 			scene->AddEntity(box1);
 			vec3 axisPos1 = position + distance/2.f;
 			vec3 axis(0,0,1);
-			HingeConstraint* dst1 = new HingeConstraint(polygon->GetRigidBody(), box1->GetRigidBody(), axis, axisPos1);
+			HingeConstraint dst1(polygon->GetRigidBody(), box1->GetRigidBody(), axis, axisPos1);
 			scene->GetPhysicManager()->AddConstraint(dst1);
 			
 			// box 2
@@ -1114,7 +1118,7 @@ private:
 			box2->SetScale(vec3(0.4,0.1,0.2));
 			scene->AddEntity(box2);
 			vec3 axisPos2 = position + distance*3.f/2.f;
-			HingeConstraint* dst2 = new HingeConstraint(box1->GetRigidBody(), box2->GetRigidBody(), axis, axisPos2);
+			HingeConstraint dst2(box1->GetRigidBody(), box2->GetRigidBody(), axis, axisPos2);
 			scene->GetPhysicManager()->AddConstraint(dst2);
 			
 		}
@@ -1135,7 +1139,7 @@ private:
 			polygon->SetScale(vec3(radius,0.2,radius));
 			polygon->SetRotation(radians(vec3(90,0,0)));
 			scene->AddEntity(polygon);
-			HingeConstraint* dst1 = new HingeConstraint(box->GetRigidBody(), polygon->GetRigidBody(), vec3(0,0,0.3), position);
+			HingeConstraint dst1(box->GetRigidBody(), polygon->GetRigidBody(), vec3(0,0,0.3), position);
 			scene->GetPhysicManager()->AddConstraint(dst1);
 			// sticks around polygon
 			double L_ = -radius-0.06;
@@ -1149,7 +1153,7 @@ private:
 				scene->AddEntity(stick);
 				vec3 axisPos = position + radius;
 				vec3 axis(0,0,1);
-				HingeConstraint* stick_dst = new HingeConstraint(polygon->GetRigidBody(), stick->GetRigidBody(), axis, axisPos);
+				HingeConstraint stick_dst(polygon->GetRigidBody(), stick->GetRigidBody(), axis, axisPos);
 				scene->GetPhysicManager()->AddConstraint(stick_dst);
 			}
 		}
@@ -1170,7 +1174,7 @@ private:
 			polygon->SetScale(vec3(radius,0.2,radius));
 			polygon->SetRotation(radians(vec3(90,0,0)));
 			scene->AddEntity(polygon);
-			HingeConstraint* dst1 = new HingeConstraint(box->GetRigidBody(), polygon->GetRigidBody(), vec3(0,0,0.3), position);
+			HingeConstraint dst1(box->GetRigidBody(), polygon->GetRigidBody(), vec3(0,0,0.3), position);
 			scene->GetPhysicManager()->AddConstraint(dst1);
 			// sticks around polygon
 			double L_ = -radius-0.06;
@@ -1184,7 +1188,7 @@ private:
 				scene->AddEntity(stick);
 				vec3 axisPos = position + radius;
 				vec3 axis(0,0,1);
-				HingeConstraint* stick_dst = new HingeConstraint(polygon->GetRigidBody(), stick->GetRigidBody(), axis, axisPos);
+				HingeConstraint stick_dst(polygon->GetRigidBody(), stick->GetRigidBody(), axis, axisPos);
 				scene->GetPhysicManager()->AddConstraint(stick_dst);
 			}
 		}
@@ -1220,7 +1224,7 @@ private:
 			stone->SetScale(vec3(0.1));
 			scene->AddEntity(stone);
 			
-			DistanceConstraint* dst = new DistanceConstraint(stone->GetRigidBody(), midpoint);
+			DistanceConstraint dst(stone->GetRigidBody(), midpoint);
 			scene->GetPhysicManager()->AddConstraint(dst);
 		}
 		// double pendulum
@@ -1237,10 +1241,10 @@ private:
 			RigidBodyModel* stone2 = new RigidBodyModel(MeshGenerator::CreateSphere(), midpoint + vec3(0,1,0.5));
 			stone2->SetScale(vec3(0.1));
 			scene->AddEntity(stone2);
-			DistanceConstraint* dst = new DistanceConstraint(stone->GetRigidBody(), midpoint);
+			DistanceConstraint dst(stone->GetRigidBody(), midpoint);
 			scene->GetPhysicManager()->AddConstraint(dst);
 			
-			TwoBodyDistanceConstraint* dst2 = new TwoBodyDistanceConstraint(stone->GetRigidBody(), stone2->GetRigidBody());
+			TwoBodyDistanceConstraint dst2(stone->GetRigidBody(), stone2->GetRigidBody());
 			scene->GetPhysicManager()->AddConstraint(dst2);
 		}
 		// impulse pendulum
@@ -1266,7 +1270,7 @@ private:
 				stone->SetScale(vec3(radius));
 				scene->AddEntity(stone);
 
-				DistanceConstraint* dst = new DistanceConstraint(stone->GetRigidBody(), midpoint);
+				DistanceConstraint dst(stone->GetRigidBody(), midpoint);
 				scene->GetPhysicManager()->AddConstraint(dst);
 			}	
 		}
@@ -1282,7 +1286,7 @@ private:
 			stone->SetScale(vec3(0.1));
 			stone->GetRigidBody()->ApplyLinearMomentum(dvec3(0,-0.2,0)); // push it out of equilibrium
 			scene->AddEntity(stone);
-			SpringConstraint* dst = new SpringConstraint(stone->GetRigidBody(), midpoint);
+			SpringConstraint dst(stone->GetRigidBody(), midpoint);
 			scene->GetPhysicManager()->AddConstraint(dst);
 		}
 		
@@ -1400,7 +1404,8 @@ private:
 		scene->Clear();
 		// Cheating :-)
 		scene->GetPhysicManager()->SetTimestepDivider(10);
-		scene->GetPhysicManager()->SetConstraintSolvingInterations(10);
+		scene->GetPhysicManager()->SetBlockSolver(true);
+		scene->GetPhysicManager()->SetShockPropagation(true); // stable towers with the default iterations
 
 		float friction = 0.3;
 		float mass = 0.5;
@@ -1552,7 +1557,7 @@ private:
 				 //stone->GetRigidBody()->ApplyLinearMomentum(dvec3(0.1,0,0)); // push it out of equilibrium
 				 scene->AddEntity(stone);
 
-				 DistanceConstraint* dst = new DistanceConstraint(stone->GetRigidBody(), midpoint);
+				 DistanceConstraint dst(stone->GetRigidBody(), midpoint);
 				 scene->GetPhysicManager()->AddConstraint(dst);
 			 }
 		}
@@ -1571,7 +1576,7 @@ private:
 			stone2->SetScale(vec3(0.1));
 			scene->AddEntity(stone2);
 
-			DistanceConstraint* dst = new DistanceConstraint(stone->GetRigidBody(), midpoint);
+			DistanceConstraint dst(stone->GetRigidBody(), midpoint);
 			scene->GetPhysicManager()->AddConstraint(dst);
 		}*/
 		double epsilon = 0.01;
@@ -1586,7 +1591,7 @@ private:
 			//~ stone->GetRigidBody()->ApplyLinearMomentum(dvec3(0,-0.5,0));
 			//~ scene->AddEntity(stone);
 			
-			//~ SoftDistanceConstraint* dst = new SoftDistanceConstraint(stone->GetRigidBody(), midpoint);
+			//~ SoftDistanceConstraint dst(stone->GetRigidBody(), midpoint);
 			//~ scene->GetPhysicManager()->AddConstraint(dst);
 			
 
@@ -1601,7 +1606,7 @@ private:
 			stone->SetScale(vec3(0.1));
 			stone->GetRigidBody()->ApplyLinearMomentum(dvec3(0,-0.2,0)); // push it out of equilibrium
 			scene->AddEntity(stone);
-			SpringConstraint* dst = new SpringConstraint(stone->GetRigidBody(), midpoint);
+			SpringConstraint dst(stone->GetRigidBody(), midpoint);
 			scene->GetPhysicManager()->AddConstraint(dst);
 			
 		}
@@ -1618,10 +1623,10 @@ private:
 			RigidBodyModel* stone2 = new RigidBodyModel(MeshGenerator::CreateSphere(), midpoint + vec3(0.5,1,0));
 			stone2->SetScale(vec3(0.1));
 			scene->AddEntity(stone2);
-			DistanceConstraint* dst = new DistanceConstraint(stone->GetRigidBody(), midpoint);
+			DistanceConstraint dst(stone->GetRigidBody(), midpoint);
 			scene->GetPhysicManager()->AddConstraint(dst);
 			
-			TwoBodyDistanceConstraint* dst2 = new TwoBodyDistanceConstraint(stone->GetRigidBody(), stone2->GetRigidBody());
+			TwoBodyDistanceConstraint dst2(stone->GetRigidBody(), stone2->GetRigidBody());
 			scene->GetPhysicManager()->AddConstraint(dst2);*/
 		}
 		
@@ -1647,7 +1652,7 @@ private:
 				newBox->SetRotation(vec3(0,0,0));
 				scene->AddEntity(newBox);
 				
-				TwoBodyDistanceConstraint* dst = new TwoBodyDistanceConstraint(newBox->GetRigidBody(), oldBox->GetRigidBody(), vec3(0,0.5,0), vec3(0,-0.5,0));
+				TwoBodyDistanceConstraint dst(newBox->GetRigidBody(), oldBox->GetRigidBody(), vec3(0,0.5,0), vec3(0,-0.5,0));
 				scene->GetPhysicManager()->AddConstraint(dst);
 				oldBox = newBox;
 			}
@@ -1676,7 +1681,7 @@ private:
 				scene->AddEntity(newBox);
 				
 				vec3 jointPos = pos + 0.5f*dst;
-				BallJointConstraint* dst = new BallJointConstraint(newBox->GetRigidBody(), oldBox->GetRigidBody(), jointPos);
+				BallJointConstraint dst(newBox->GetRigidBody(), oldBox->GetRigidBody(), jointPos);
 				scene->GetPhysicManager()->AddConstraint(dst);
 				oldBox = newBox;
 			}
@@ -1698,7 +1703,7 @@ private:
 			//~ box2->SetRotation(vec3(0,0,0));
 			scene->AddEntity(box2);
 			
-			HingeConstraint* dst = new HingeConstraint(box1->GetRigidBody(), box2->GetRigidBody(), vec3(0,0,1), vec3(2.5,1,0));
+			HingeConstraint dst(box1->GetRigidBody(), box2->GetRigidBody(), vec3(0,0,1), vec3(2.5,1,0));
 			scene->GetPhysicManager()->AddConstraint(dst);
 		}
 		
@@ -1718,7 +1723,7 @@ private:
 			box2->SetRotation(radians(vec3(0,0,90)));
 			scene->AddEntity(box2);
 			
-			HingeConstraint* dst = new HingeConstraint(box1->GetRigidBody(), box2->GetRigidBody(), vec3(0,0,1), position - vec3(0,.5,0));
+			HingeConstraint dst(box1->GetRigidBody(), box2->GetRigidBody(), vec3(0,0,1), position - vec3(0,.5,0));
 			scene->GetPhysicManager()->AddConstraint(dst);
 		}
 	
@@ -1772,8 +1777,11 @@ private:
 			TopBox->SetRotation(vec3(0,0,0));	/// TODO: why is the standard rotation not (0,0,0) ?
 			TopBox->SetStatic();
 			scene->AddEntity(TopBox);
+
+			// the rope is an articulation, the joints can not stretch
+			Articulation* rope = new Articulation(TopBox->GetRigidBody());
+			int link = 0;
 			
-			RigidBodyModel* oldBox = TopBox;
 			for(int i = 1; i <= length; ++i)
 			{
 				vec3 dist(0, L*1.1*i, 0);
@@ -1783,9 +1791,7 @@ private:
 				newBox->SetRotation(vec3(0,0,0));
 				scene->AddEntity(newBox);
 				
-				BallJointConstraint* dst = new BallJointConstraint(newBox->GetRigidBody(), oldBox->GetRigidBody(), fixPoint - dist + vec3(0,L/2.,0));
-				scene->GetPhysicManager()->AddConstraint(dst);
-				oldBox = newBox;
+				link = rope->AddSphericalLink(link, newBox->GetRigidBody(), fixPoint - dist + vec3(0,L/2.,0));
 			}
 
 			double ballSize = 0.2;
@@ -1797,8 +1803,8 @@ private:
 			ball->SetRotation(vec3(0,0,0));
 			scene->AddEntity(ball);
 			
-			BallJointConstraint* dst = new BallJointConstraint(ball->GetRigidBody(), oldBox->GetRigidBody(), fixPoint - dist + vec3(0,(L+ballSize)/2.,0));
-			scene->GetPhysicManager()->AddConstraint(dst);
+			rope->AddSphericalLink(link, ball->GetRigidBody(), fixPoint - dist + vec3(0,(L+ballSize)/2.,0));
+			scene->GetPhysicManager()->AddArticulation(rope);
 		}
 
 		RigidBodyModel* plane = new RigidBodyModel(MeshGenerator::CreatePlane(), vec3(0,-2,0));
@@ -1828,6 +1834,8 @@ private:
 			double dy = dx;
 			const int x_size = 10;
 			const int y_size = 10;
+			const double stiffness = 2000; // implicit springs, no extra substeps needed
+			const double damping = 5;
 			RigidBodyModel **RidgidBodyArray = new RigidBodyModel*[x_size*y_size];
 			
 			for(int x = 0; x < x_size; ++x)
@@ -1850,7 +1858,7 @@ private:
 				for(int y = 1; y < y_size; ++y)
 				{
 					RigidBodyModel* next = RidgidBodyArray[y*x_size+x];
-					SoftTwoBodyDistanceConstraint* dst = new SoftTwoBodyDistanceConstraint(last->GetRigidBody(), next->GetRigidBody());
+					SoftTwoBodyDistanceConstraint dst(last->GetRigidBody(), next->GetRigidBody(), vec3(0), vec3(0), stiffness, damping);
 					scene->GetPhysicManager()->AddConstraint(dst);
 					last = next;
 				}
@@ -1861,7 +1869,7 @@ private:
 				for(int x = 1; x < x_size; ++x)
 				{
 					RigidBodyModel* next = RidgidBodyArray[y*x_size+x];
-					SoftTwoBodyDistanceConstraint* dst = new SoftTwoBodyDistanceConstraint(last->GetRigidBody(), next->GetRigidBody());
+					SoftTwoBodyDistanceConstraint dst(last->GetRigidBody(), next->GetRigidBody(), vec3(0), vec3(0), stiffness, damping);
 					scene->GetPhysicManager()->AddConstraint(dst);
 					last  = next;
 				}
@@ -1999,7 +2007,7 @@ private:
 				carWheel->SetRotation(radians(vec3(90,0,0)));
 				
 				// axis / hinge constraint
-				HingeConstraint* hinge = new HingeConstraint(carBody->GetRigidBody(), carWheel->GetRigidBody(), wheelAxis, posAxis[i]);
+				HingeConstraint hinge(carBody->GetRigidBody(), carWheel->GetRigidBody(), wheelAxis, posAxis[i]);
 				scene->GetPhysicManager()->AddConstraint(hinge);
 				
 				car->AddChild(carWheel);
@@ -2189,7 +2197,7 @@ private:
 				parent->AddChild(fan);
 				
 				// axis / hinge constraint
-				HingeConstraint* hinge = new HingeConstraint(decoration->GetRigidBody(), fan->GetRigidBody(), vec3(0,0,1), fanPos);
+				HingeConstraint hinge(decoration->GetRigidBody(), fan->GetRigidBody(), vec3(0,0,1), fanPos);
 				scene->GetPhysicManager()->AddConstraint(hinge);
 			}
 		}
@@ -2377,7 +2385,7 @@ private:
 			stone->GetRigidBody()->ApplyLinearMomentum(dvec3(4.4,0,0)); // push it out of equilibrium
 			scene->AddEntity(stone);
 
-			DistanceConstraint* dst = new DistanceConstraint(stone->GetRigidBody(), midpoint);
+			DistanceConstraint dst(stone->GetRigidBody(), midpoint);
 			scene->GetPhysicManager()->AddConstraint(dst);
 		}
 
@@ -2778,7 +2786,7 @@ private:
 //			stone->GetRigidBody()->ApplyLinearMomentum(dvec3(4.4,0,0)); // push it out of equilibrium
 			scene->AddEntity(stone);
 
-			DistanceConstraint* dst = new DistanceConstraint(stone->GetRigidBody(), midpoint);
+			DistanceConstraint dst(stone->GetRigidBody(), midpoint);
 			scene->GetPhysicManager()->AddConstraint(dst);
 		}
 
@@ -2794,7 +2802,7 @@ private:
 			stone->GetRigidBody()->ApplyLinearMomentum(dvec3(2,0,0)); // push it out of equilibrium
 			scene->AddEntity(stone);
 
-			DistanceConstraint* dst = new DistanceConstraint(stone->GetRigidBody(), midpoint);
+			DistanceConstraint dst(stone->GetRigidBody(), midpoint);
 			scene->GetPhysicManager()->AddConstraint(dst);
 		}
 
@@ -2817,7 +2825,7 @@ private:
 			ball->SetScale(vec3(0.3));
 			scene->AddEntity(ball);
 			
-			HingeConstraint* dst = new HingeConstraint(box1->GetRigidBody(), ball->GetRigidBody(), vec3(0,0,1), position - vec3(0,.1,0));
+			HingeConstraint dst(box1->GetRigidBody(), ball->GetRigidBody(), vec3(0,0,1), position - vec3(0,.1,0));
 			scene->GetPhysicManager()->AddConstraint(dst);
 		}
 
@@ -2836,7 +2844,7 @@ private:
 			ball->SetRotation(vec3(0,0,radians(60.0f)));
 			scene->AddEntity(ball);
 			
-			HingeConstraint* dst = new HingeConstraint(box1->GetRigidBody(), ball->GetRigidBody(), vec3(0,0,1), position - vec3(0,.1,0));
+			HingeConstraint dst(box1->GetRigidBody(), ball->GetRigidBody(), vec3(0,0,1), position - vec3(0,.1,0));
 			scene->GetPhysicManager()->AddConstraint(dst);
 		}
 
@@ -96,9 +96,9 @@ int main(int argc, char** argv)
 		}
 	}
 
+	delete inputManager; // deletes also all processors (they detach from the scene, e.g. the replay recorder)
 	delete scene;
 	delete renderManager;
-	delete inputManager; // deletes also all processors
 	delete windowManager;
 
 	return 0;
@@ -0,0 +1,78 @@
+/*
+ * Plays back a replay file recorded with ReplayRecorder (no physics, only the transforms are drawn)
+ * usage: replay_viewer [file] (default: replay.phr)
+ */
+
+#include <iostream>
+
+#include <GL/glew.h>
+#include <glfw3.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+using namespace glm;
+
+#include "Scene.h"
+#include "Camera.h"
+#include "Light.h"
+#include "ReplayPlayer.h"
+#include "CameraInputProcessor.h"
+#include "ReplayInputProcessor.h"
+#include "InputManager.h"
+#include "RenderManager.h"
+#include "DesktopWindowManager.h"
+
+
+int main(int argc, char** argv)
+{
+	const char* path = argc >= 2 ? argv[1] : "replay.phr";
+
+	// create window
+	DesktopWindowManager* windowManager = new DesktopWindowManager(false, -1, -1);
+	if (!windowManager->CreateWindow()) return -1;
+
+	// scene without physic manager
+	Scene* scene = new Scene(false);
+
+	ReplayPlayer* player = new ReplayPlayer(path);
+	if (!player->IsOpen())
+	{
+		delete player;
+		delete scene;
+		delete windowManager;
+		return -1;
+	}
+	scene->AddEntity(player);
+
+	Camera* camera = new Camera(vec3(0.0f, 3.0f, 10.0f));
+	scene->SetCamera(camera);
+
+	Light* light = new Light(vec3(-19,25,9), vec3(-5,0,0), 50, 5, 50);
+	scene->SetLight(light);
+
+	RenderManager* renderManager = new RenderManager(windowManager, scene);
+	InputManager* inputManager = new InputManager(windowManager);
+	inputManager->RegisterInputProcessor(new CameraInputProcessor(camera));
+	inputManager->RegisterInputProcessor(new ReplayInputProcessor(player));
+
+	// draw as fast as possible, the player follows the recorded time
+	double lastFrame = glfwGetTime();
+	while(windowManager->IsWindowRunning())
+	{
+		double currentFrame = glfwGetTime();
+		double deltaTime = currentFrame - lastFrame;
+		lastFrame = currentFrame;
+
+		inputManager->Update(deltaTime);
+		scene->Update(deltaTime);
+		renderManager->Draw();
+	}
+
+	delete scene;
+	delete renderManager;
+	delete inputManager; // deletes also all processors
+	delete windowManager;
+
+	return 0;
+}